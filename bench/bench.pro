@@ -0,0 +1,15 @@
+TEMPLATE = app
+
+CONFIG += c++11
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG -= qt
+
+SOURCES += main.cpp
+INCLUDEPATH += ../src
+
+linux: LIBS += -lrt
+
+TARGET      = mms-bench
+DESTDIR     = ../bin
+OBJECTS_DIR = ../build/bench
@@ -0,0 +1,368 @@
+// A synthetic mouse algorithm for measuring the throughput of the simulator's
+// stdin/stdout protocol. It sends a fixed mix of commands, timing the round
+// trip of each one, and prints the results to stderr (which the simulator
+// passes through in headless mode) as "key value" lines.
+//
+// Usage: mms-bench [--mix walls|viz|move|mixed] [--count N] [--binary] [--shm]
+//
+// With --shm, commands and responses go through the shared memory rings named
+// by the MMS_SHM environment variable (see mms --shm) instead of stdin/stdout.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "SharedMemoryRing.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Viz commands have no response, so they're sent in batches
+// followed by a query that acts as a fence
+const int VIZ_BATCH_SIZE = 100;
+
+// Opcodes of the binary protocol
+const uint8_t OP_MAZE_WIDTH = 0x01;
+const uint8_t OP_MAZE_HEIGHT = 0x02;
+const uint8_t OP_WALL_FRONT = 0x10;
+const uint8_t OP_WALL_BACK = 0x11;
+const uint8_t OP_WALL_LEFT = 0x12;
+const uint8_t OP_WALL_RIGHT = 0x13;
+const uint8_t OP_MOVE_FORWARD = 0x20;
+const uint8_t OP_TURN_RIGHT = 0x22;
+const uint8_t OP_TURN_LEFT = 0x23;
+const uint8_t OP_SET_COLOR = 0x32;
+const uint8_t OP_SET_TEXT = 0x35;
+
+bool g_binary = false;
+mms::SharedMemoryRegion *g_shm = nullptr;
+int g_doorbell = -1;
+pid_t g_simulatorPid = 0;
+std::vector<double> g_roundTrips;  // microseconds, one per timed request
+long g_numCommands = 0;
+
+// ----- Transport -----
+
+bool openSharedMemory() {
+  const char *name = std::getenv("MMS_SHM");
+  if (name == nullptr) {
+    return false;
+  }
+  int fd = shm_open(name, O_RDWR, 0);
+  if (fd == -1) {
+    return false;
+  }
+  void *memory = mmap(nullptr, sizeof(mms::SharedMemoryRegion),
+                      PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) {
+    return false;
+  }
+  g_shm = static_cast<mms::SharedMemoryRegion *>(memory);
+  if (g_shm->magic != mms::SharedMemoryRegion::MAGIC) {
+    return false;
+  }
+  g_doorbell = open(g_shm->doorbellPath, O_WRONLY | O_NONBLOCK);
+  g_simulatorPid = getppid();
+  return g_doorbell != -1;
+}
+
+// Called while a ring is empty (or full), exits if the simulator goes away
+void waitForSimulator() {
+  // The simulator is the parent, so it's gone once we've been reparented.
+  // Checking on every call would cost a syscall per spin.
+  static int numWaits = 0;
+  numWaits += 1;
+  if (numWaits % 1024 == 0 && getppid() != g_simulatorPid) {
+    std::exit(1);
+  }
+  // Let the simulator run, in case it shares this core
+  std::this_thread::yield();
+}
+
+void writeBytes(const std::string &bytes) {
+  if (g_shm == nullptr) {
+    std::fwrite(bytes.data(), 1, bytes.size(), stdout);
+    return;
+  }
+  // Wait until there's room, the simulator drains the ring as it goes
+  size_t written = 0;
+  while (written < bytes.size()) {
+    uint32_t count = g_shm->commands.write(bytes.data() + written,
+                                           bytes.size() - written);
+    // Wake the simulator if it went to sleep on an empty ring
+    if (count > 0 && g_shm->shouldRingDoorbell()) {
+      char byte = 0;
+      if (write(g_doorbell, &byte, 1) == -1) {
+        // The FIFO is full, which wakes the simulator just the same
+      }
+    }
+    if (count == 0) {
+      waitForSimulator();
+    }
+    written += count;
+  }
+}
+
+void flush() {
+  if (g_shm == nullptr) {
+    std::fflush(stdout);
+  }
+}
+
+// Reads exactly size bytes, exits if the simulator goes away
+void readBytes(char *bytes, size_t size) {
+  if (g_shm == nullptr) {
+    if (std::fread(bytes, 1, size, stdin) != size) {
+      std::exit(1);
+    }
+    return;
+  }
+  size_t read = 0;
+  while (read < size) {
+    uint32_t count = g_shm->responses.read(bytes + read, size - read);
+    if (count == 0) {
+      waitForSimulator();
+    }
+    read += count;
+  }
+}
+
+// Reads up to and including the next newline, which is removed
+std::string readLine() {
+  std::string line;
+  if (g_shm == nullptr) {
+    char buffer[64];
+    if (std::fgets(buffer, sizeof(buffer), stdin) == nullptr) {
+      std::exit(1);
+    }
+    line = buffer;
+  } else {
+    char c = '\0';
+    while (c != '\n') {
+      readBytes(&c, 1);
+      line += c;
+    }
+  }
+  line.erase(line.find_last_not_of("\r\n") + 1);
+  return line;
+}
+
+std::string int16(int value) {
+  std::string bytes(2, '\0');
+  bytes[0] = static_cast<char>(value & 0xFF);
+  bytes[1] = static_cast<char>((value >> 8) & 0xFF);
+  return bytes;
+}
+
+// Sends a command that has a response and waits for it. Text responses are
+// returned as is; binary ones are converted to the equivalent text.
+std::string request(const std::string &text, const std::string &binary,
+                    int responseSize) {
+  Clock::time_point start = Clock::now();
+  std::string response;
+  if (g_binary) {
+    writeBytes(binary);
+    flush();
+    uint8_t bytes[4] = {0};
+    readBytes(reinterpret_cast<char *>(bytes), responseSize);
+    if (responseSize == 4) {
+      response = std::to_string(bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) |
+                                (bytes[3] << 24));
+    } else {
+      static const char *names[] = {"false", "true", "ack", "crash"};
+      response = bytes[0] < 4 ? names[bytes[0]] : "";
+    }
+  } else {
+    writeBytes(text + "\n");
+    flush();
+    response = readLine();
+  }
+  std::chrono::duration<double, std::micro> elapsed = Clock::now() - start;
+  g_roundTrips.push_back(elapsed.count());
+  g_numCommands += 1;
+  return response;
+}
+
+// Sends a command without a response, left in the buffer until the next flush
+void send(const std::string &text, const std::string &binary) {
+  writeBytes(g_binary ? binary : text + "\n");
+  g_numCommands += 1;
+}
+
+// ----- Commands -----
+
+int mazeWidth() {
+  return std::atoi(request("mazeWidth", {char(OP_MAZE_WIDTH)}, 4).c_str());
+}
+
+int mazeHeight() {
+  return std::atoi(request("mazeHeight", {char(OP_MAZE_HEIGHT)}, 4).c_str());
+}
+
+bool wall(const std::string &name, uint8_t opcode) {
+  return request(name, std::string(1, char(opcode)) + int16(1), 1) == "true";
+}
+
+bool wallFront() { return wall("wallFront", OP_WALL_FRONT); }
+bool wallLeft() { return wall("wallLeft", OP_WALL_LEFT); }
+
+bool moveForward(int distance) {
+  return request("moveForward " + std::to_string(distance),
+                 std::string(1, char(OP_MOVE_FORWARD)) + int16(distance),
+                 1) == "ack";
+}
+
+void turnRight() { request("turnRight", {char(OP_TURN_RIGHT)}, 1); }
+void turnLeft() { request("turnLeft", {char(OP_TURN_LEFT)}, 1); }
+
+void setColor(int x, int y, char color) {
+  send("setColor " + std::to_string(x) + " " + std::to_string(y) + " " + color,
+       std::string(1, char(OP_SET_COLOR)) + int16(x) + int16(y) + color);
+}
+
+void setText(int x, int y, const std::string &text) {
+  send("setText " + std::to_string(x) + " " + std::to_string(y) + " " + text,
+       std::string(1, char(OP_SET_TEXT)) + int16(x) + int16(y) +
+           char(text.size()) + text);
+}
+
+// ----- Mixes -----
+
+void runWalls(long count) {
+  static const char *names[] = {"wallFront", "wallRight", "wallLeft",
+                                "wallBack"};
+  static const uint8_t opcodes[] = {OP_WALL_FRONT, OP_WALL_RIGHT, OP_WALL_LEFT,
+                                    OP_WALL_BACK};
+  for (long i = 0; i < count; i += 1) {
+    wall(names[i % 4], opcodes[i % 4]);
+  }
+}
+
+void runViz(long count, int width, int height) {
+  static const char colors[] = {'r', 'g', 'b', 'y', 'c', 'o'};
+  long sent = 0;
+  while (sent < count) {
+    for (int i = 0; i < VIZ_BATCH_SIZE && sent < count; i += 1, sent += 1) {
+      int x = sent % width;
+      int y = (sent / width) % height;
+      if (sent % 2 == 0) {
+        setColor(x, y, colors[sent % 6]);
+      } else {
+        setText(x, y, std::to_string(sent % 1000));
+      }
+    }
+    mazeWidth();
+  }
+}
+
+void runMove(long count, int width, int height) {
+  // Circles the perimeter, which is open in a blank maze
+  for (long i = 0; i < count; i += 2) {
+    moveForward((i / 2) % 2 == 0 ? height - 1 : width - 1);
+    turnRight();
+  }
+}
+
+void runMixed(long count) {
+  // A left-wall follower that also marks every cell it visits,
+  // which resembles the command mix of a real algorithm
+  int x = 0;
+  int y = 0;
+  int direction = 0;  // 0 = north, 1 = east, 2 = south, 3 = west
+  static const int dx[] = {0, 1, 0, -1};
+  static const int dy[] = {1, 0, -1, 0};
+  while (g_numCommands < count) {
+    setColor(x, y, 'G');
+    if (!wallLeft()) {
+      turnLeft();
+      direction = (direction + 3) % 4;
+    } else if (wallFront()) {
+      turnRight();
+      direction = (direction + 1) % 4;
+      continue;
+    }
+    if (moveForward(1)) {
+      x += dx[direction];
+      y += dy[direction];
+    }
+  }
+}
+
+double percentile(std::vector<double> values, double p) {
+  if (values.empty()) {
+    return 0.0;
+  }
+  size_t index = static_cast<size_t>(p * (values.size() - 1));
+  std::nth_element(values.begin(), values.begin() + index, values.end());
+  return values.at(index);
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  std::string mix = "mixed";
+  long count = 100000;
+  for (int i = 1; i < argc; i += 1) {
+    if (std::strcmp(argv[i], "--binary") == 0) {
+      g_binary = true;
+    } else if (std::strcmp(argv[i], "--shm") == 0) {
+      if (!openSharedMemory()) {
+        std::cerr << "Shared memory is unavailable" << std::endl;
+        return 1;
+      }
+    } else if (std::strcmp(argv[i], "--mix") == 0 && i + 1 < argc) {
+      mix = argv[++i];
+    } else if (std::strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+      count = std::atol(argv[++i]);
+    }
+  }
+
+  if (g_binary) {
+    // The handshake is the last text command
+    writeBytes("useBinaryProtocol\n");
+    flush();
+    readLine();
+  }
+  int width = mazeWidth();
+  int height = mazeHeight();
+  g_roundTrips.clear();
+  g_numCommands = 0;
+
+  Clock::time_point start = Clock::now();
+  if (mix == "walls") {
+    runWalls(count);
+  } else if (mix == "viz") {
+    runViz(count, width, height);
+  } else if (mix == "move") {
+    runMove(count, width, height);
+  } else if (mix == "mixed") {
+    runMixed(count);
+  } else {
+    std::cerr << "Unknown mix: " << mix << std::endl;
+    return 1;
+  }
+  std::chrono::duration<double> elapsed = Clock::now() - start;
+
+  std::cerr << "mix " << mix << (g_binary ? " (binary)" : "")
+            << (g_shm != nullptr ? " (shm)" : "") << std::endl;
+  std::cerr << "bench-commands " << g_numCommands << std::endl;
+  std::cerr << "bench-seconds " << elapsed.count() << std::endl;
+  std::cerr << "commands-per-second " << g_numCommands / elapsed.count()
+            << std::endl;
+  std::cerr << "rtt-p50-us " << percentile(g_roundTrips, 0.50) << std::endl;
+  std::cerr << "rtt-p99-us " << percentile(g_roundTrips, 0.99) << std::endl;
+  return 0;
+}
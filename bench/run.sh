@@ -0,0 +1,24 @@
+#!/usr/bin/env bash
+# Runs every command mix through the real simulator in headless mode.
+# Headless mode has no maze view, so the viz mix (and the coloring in mixed)
+# only measures protocol parsing: visualization commands are dropped there.
+# Usage: bench/run.sh [count]  (after building src/mms.pro and bench/bench.pro)
+
+set -e
+
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+MMS="$ROOT/bin/mms"
+BENCH="$ROOT/bin/mms-bench"
+MAZE="$ROOT/src/resources/mazes/blank.num"
+COUNT="${1:-100000}"
+
+for TRANSPORT in "" "--shm"; do
+  for PROTOCOL in "" "--binary"; do
+    for MIX in walls viz move mixed; do
+      "$MMS" --headless --maze "$MAZE" $TRANSPORT \
+        --algo "$BENCH --mix $MIX --count $COUNT $PROTOCOL $TRANSPORT" \
+        2>&1 | grep -E '^(mix|commands|rtt|cpu-per-command)'
+      echo
+    done
+  done
+done
@@ -0,0 +1,398 @@
+#include "BatchRunner.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QTimer>
+#include <algorithm>
+
+#include "AssertMacros.h"
+#include "HeadlessRunner.h"
+#include "Maze.h"
+#include "SettingsMouseAlgos.h"
+#include "Stats.h"
+
+namespace mms {
+
+BatchRunner::BatchRunner(QObject *parent)
+    : QObject(parent),
+      m_timeoutSeconds(0),
+      m_sharedMemory(false),
+      m_scheduler(nullptr),
+      m_isServer(false) {}
+
+BatchRunner::~BatchRunner() {
+  QVector<QProcess *> workers = m_workers;
+  for (const QVector<QProcess *> &servers : m_servers) {
+    workers += servers;
+  }
+  for (QProcess *worker : workers) {
+    if (worker != nullptr) {
+      worker->disconnect(this);
+      worker->kill();
+      worker->waitForFinished();
+    }
+  }
+  delete m_scheduler;
+}
+
+bool BatchRunner::start(const QString &mazeDirectory,
+                        const QStringList &mouseAlgos, int numWorkers,
+                        int timeoutSeconds, bool sharedMemory, bool server) {
+  // Only one batch per runner
+  ASSERT_TR(m_scheduler == nullptr);
+  QTextStream err(stderr);
+
+  // Look up the algorithms the same way the window does
+  for (const QString &name : mouseAlgos) {
+    if (!SettingsMouseAlgos::names().contains(name)) {
+      err << "Unknown mouse algorithm: " << name << Qt::endl;
+      return false;
+    }
+    MouseAlgo mouseAlgo = {name, SettingsMouseAlgos::getRunCommand(name),
+                           SettingsMouseAlgos::getDirectory(name)};
+    if (mouseAlgo.runCommand.isEmpty()) {
+      err << "Empty run command for mouse algorithm: " << name << Qt::endl;
+      return false;
+    }
+    m_mouseAlgos.append(mouseAlgo);
+  }
+  if (m_mouseAlgos.isEmpty()) {
+    err << "No mouse algorithms given" << Qt::endl;
+    return false;
+  }
+
+  // Every file in the directory is treated as a maze; invalid
+  // ones are reported as failures by the workers
+  QDir dir(mazeDirectory);
+  if (!dir.exists()) {
+    err << "Maze directory does not exist: " << mazeDirectory << Qt::endl;
+    return false;
+  }
+  QList<QFileInfo> mazeFiles = dir.entryInfoList(QDir::Files, QDir::Name);
+  if (mazeFiles.isEmpty()) {
+    err << "No maze files in directory: " << mazeDirectory << Qt::endl;
+    return false;
+  }
+
+  // Bigger mazes take longer to solve, so the
+  // number of tiles is used as the cost estimate
+  QVector<double> costs;
+  for (const QFileInfo &info : mazeFiles) {
+    double cost = 0.0;
+    Maze *maze = Maze::fromFile(info.absoluteFilePath());
+    if (maze != nullptr) {
+      cost = maze->getWidth() * maze->getHeight();
+      delete maze;
+    }
+    for (int i = 0; i < m_mouseAlgos.size(); i += 1) {
+      m_results.append({i, info.absoluteFilePath(), QString(), {}});
+      costs.append(cost);
+    }
+  }
+
+  // Fill the pool
+  m_timeoutSeconds = qMax(0, timeoutSeconds);
+  m_sharedMemory = sharedMemory;
+  m_isServer = server;
+  m_scheduler = new WorkStealingScheduler(
+      qMin(qMax(1, numWorkers), static_cast<int>(m_results.size())));
+  m_scheduler->addJobs(costs);
+  m_workers.fill(nullptr, m_scheduler->numWorkers());
+  if (m_isServer) {
+    m_servers.fill(QVector<QProcess *>(m_mouseAlgos.size(), nullptr),
+                   m_scheduler->numWorkers());
+    m_serverJobs.fill(-1, m_scheduler->numWorkers());
+    m_serverOutput.fill(QByteArray(), m_scheduler->numWorkers());
+  }
+  for (int slot = 0; slot < m_workers.size(); slot += 1) {
+    startWorker(slot);
+  }
+  return true;
+}
+
+bool BatchRunner::isDone() const {
+  if (m_isServer) {
+    return std::all_of(m_serverJobs.begin(), m_serverJobs.end(),
+                       [](int index) { return index == -1; });
+  }
+  return std::all_of(m_workers.begin(), m_workers.end(),
+                     [](QProcess *worker) { return worker == nullptr; });
+}
+
+void BatchRunner::finish() {
+  printTable();
+  if (m_mouseAlgos.size() > 1) {
+    printLeaderboard();
+  }
+  bool allSolved = true;
+  for (const Result &result : m_results) {
+    allSolved &= result.summary.value("solved") == "true";
+  }
+  emit finished(allSolved ? 0 : 1);
+}
+
+void BatchRunner::startWorker(int slot) {
+  if (m_isServer) {
+    startServerJob(slot);
+    return;
+  }
+  ASSERT_TR(m_workers.at(slot) == nullptr);
+  int index = m_scheduler->next(slot);
+  if (index == -1) {
+    if (isDone()) {
+      finish();
+    }
+    return;
+  }
+  const Result &result = m_results.at(index);
+  const MouseAlgo &mouseAlgo = m_mouseAlgos.at(result.mouseAlgo);
+
+  // The worker's stdout carries its summary; algorithm
+  // logs would only interleave, so they're discarded
+  QProcess *worker = new QProcess(this);
+  worker->setStandardErrorFile(QProcess::nullDevice());
+  m_workers[slot] = worker;
+
+  connect(worker,
+          static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(
+              &QProcess::finished),
+          this, [=]() { onWorkerExit(slot, index); });
+  connect(worker, &QProcess::errorOccurred, this,
+          [=](QProcess::ProcessError error) {
+            // No finished signal follows a failure to start
+            if (error == QProcess::FailedToStart) {
+              onWorkerExit(slot, index);
+            }
+          });
+
+  if (m_timeoutSeconds > 0) {
+    QTimer::singleShot(m_timeoutSeconds * 1000, worker, [=]() {
+      m_results[index].status = "TIMEOUT";
+      worker->kill();
+    });
+  }
+
+  worker->start(QCoreApplication::applicationFilePath(),
+                HeadlessRunner::workerArguments(
+                    result.mazePath, mouseAlgo.runCommand, mouseAlgo.directory,
+                    m_sharedMemory));
+}
+
+void BatchRunner::onWorkerExit(int slot, int index) {
+  QProcess *worker = m_workers.at(slot);
+  m_workers[slot] = nullptr;
+  worker->disconnect(this);
+  worker->deleteLater();
+
+  Result &result = m_results[index];
+  result.summary =
+      HeadlessRunner::parseSummary(worker->readAllStandardOutput());
+  if (result.status.isEmpty()) {
+    result.status = result.summary.value("status", "FAILED");
+  }
+
+  startWorker(slot);
+}
+
+void BatchRunner::startServerJob(int slot) {
+  ASSERT_EQ(m_serverJobs.at(slot), -1);
+  int index = m_scheduler->next(slot);
+  if (index == -1) {
+    // No jobs are left anywhere, and idle servers exit once stdin is closed
+    for (QProcess *server : m_servers.at(slot)) {
+      if (server != nullptr) {
+        server->closeWriteChannel();
+      }
+    }
+    if (isDone()) {
+      finish();
+    }
+    return;
+  }
+  const Result &result = m_results.at(index);
+  QProcess *server = m_servers.at(slot).at(result.mouseAlgo);
+  if (server == nullptr) {
+    server = startServer(slot, result.mouseAlgo);
+  }
+  m_serverJobs[slot] = index;
+  m_serverOutput[slot].clear();
+
+  // Killing the server is the only way to stop a run, the
+  // next job for the same algorithm starts a new one
+  if (m_timeoutSeconds > 0) {
+    QTimer::singleShot(m_timeoutSeconds * 1000, server, [=]() {
+      if (m_serverJobs.at(slot) == index) {
+        m_results[index].status = "TIMEOUT";
+        server->kill();
+      }
+    });
+  }
+
+  server->write((result.mazePath + "\n").toUtf8());
+}
+
+QProcess *BatchRunner::startServer(int slot, int mouseAlgo) {
+  const MouseAlgo &algo = m_mouseAlgos.at(mouseAlgo);
+  QProcess *server = new QProcess(this);
+  server->setStandardErrorFile(QProcess::nullDevice());
+  m_servers[slot][mouseAlgo] = server;
+
+  connect(server, &QProcess::readyReadStandardOutput, this,
+          [=]() { onServerOutput(slot, server); });
+  connect(server,
+          static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(
+              &QProcess::finished),
+          this, [=]() { onServerExit(slot, mouseAlgo); });
+  connect(server, &QProcess::errorOccurred, this,
+          [=](QProcess::ProcessError error) {
+            if (error == QProcess::FailedToStart) {
+              onServerExit(slot, mouseAlgo);
+            }
+          });
+
+  server->start(QCoreApplication::applicationFilePath(),
+                HeadlessRunner::serverArguments(algo.runCommand,
+                                                algo.directory));
+  return server;
+}
+
+void BatchRunner::onServerOutput(int slot, QProcess *server) {
+  m_serverOutput[slot].append(server->readAllStandardOutput());
+
+  // The stats of each run end with a blank line
+  int end = m_serverOutput.at(slot).indexOf("\n\n");
+  if (end != -1 && m_serverJobs.at(slot) != -1) {
+    finishServerJob(slot, m_serverOutput.at(slot).left(end));
+  }
+}
+
+void BatchRunner::onServerExit(int slot, int mouseAlgo) {
+  QProcess *server = m_servers.at(slot).at(mouseAlgo);
+  m_servers[slot][mouseAlgo] = nullptr;
+  server->disconnect(this);
+  server->deleteLater();
+
+  // Only matters if the server was in the middle of a run
+  int index = m_serverJobs.at(slot);
+  if (index != -1 && m_results.at(index).mouseAlgo == mouseAlgo) {
+    m_serverOutput[slot].append(server->readAllStandardOutput());
+    finishServerJob(slot, m_serverOutput.at(slot));
+  }
+}
+
+void BatchRunner::finishServerJob(int slot, const QByteArray &output) {
+  Result &result = m_results[m_serverJobs.at(slot)];
+  result.summary = HeadlessRunner::parseSummary(output);
+  if (result.status.isEmpty()) {
+    result.status = result.summary.value("status", "FAILED");
+  }
+  m_serverJobs[slot] = -1;
+  m_serverOutput[slot].clear();
+  startServerJob(slot);
+}
+
+void BatchRunner::printTable() const {
+  QStringList headers = {"MAZE",  "STATUS",   "SOLVED",
+                         "STEPS", "BEST RUN", "SCORE"};
+  if (m_mouseAlgos.size() > 1) {
+    headers.prepend("MOUSE");
+  }
+
+  QVector<QStringList> rows;
+  int numSolved = 0;
+  double totalSteps = 0.0;
+  for (const Result &result : m_results) {
+    auto value = [&](const QString &key) {
+      return result.summary.value(key, "-1");
+    };
+    bool solved = value("solved") == "true";
+    if (solved) {
+      numSolved += 1;
+      totalSteps += value("total-distance").toDouble();
+    }
+    QStringList row = {QFileInfo(result.mazePath).fileName(),
+                       result.status,
+                       solved ? "yes" : "no",
+                       value("total-distance"),
+                       value("best-run-distance"),
+                       value("score")};
+    if (m_mouseAlgos.size() > 1) {
+      row.prepend(m_mouseAlgos.at(result.mouseAlgo).name);
+    }
+    rows.append(row);
+  }
+
+  printColumns(headers, rows);
+  QTextStream out(stdout);
+  out << Qt::endl;
+  out << "solved " << numSolved << "/" << m_results.size() << Qt::endl;
+  out << "average-steps "
+      << (numSolved > 0 ? QString::number(totalSteps / numSolved, 'f', 1)
+                        : QString("-1"))
+      << Qt::endl;
+  out << "stolen-jobs " << m_scheduler->numStolen() << Qt::endl;
+}
+
+void BatchRunner::printLeaderboard() const {
+  // Runs that didn't finish get the same score as unsolved mazes
+  QVector<int> solved(m_mouseAlgos.size(), 0);
+  QVector<double> totalScore(m_mouseAlgos.size(), 0.0);
+  QVector<int> numRuns(m_mouseAlgos.size(), 0);
+  for (const Result &result : m_results) {
+    bool ok = false;
+    double score = result.summary.value("score").toDouble(&ok);
+    totalScore[result.mouseAlgo] += ok ? score : Stats::UNSOLVED_SCORE;
+    solved[result.mouseAlgo] += result.summary.value("solved") == "true";
+    numRuns[result.mouseAlgo] += 1;
+  }
+
+  // Lower scores are better, ties go to whoever solved more mazes
+  QVector<int> ranking;
+  for (int i = 0; i < m_mouseAlgos.size(); i += 1) {
+    ranking.append(i);
+  }
+  std::stable_sort(ranking.begin(), ranking.end(), [&](int a, int b) {
+    double lhs = totalScore.at(a) / numRuns.at(a);
+    double rhs = totalScore.at(b) / numRuns.at(b);
+    return lhs != rhs ? lhs < rhs : solved.at(a) > solved.at(b);
+  });
+
+  QVector<QStringList> rows;
+  for (int rank = 0; rank < ranking.size(); rank += 1) {
+    int i = ranking.at(rank);
+    rows.append({QString::number(rank + 1), m_mouseAlgos.at(i).name,
+                 QString("%1/%2").arg(solved.at(i)).arg(numRuns.at(i)),
+                 QString::number(totalScore.at(i) / numRuns.at(i), 'f', 1)});
+  }
+
+  QTextStream(stdout) << Qt::endl;
+  printColumns({"RANK", "MOUSE", "SOLVED", "AVERAGE SCORE"}, rows);
+}
+
+void BatchRunner::printColumns(const QStringList &headers,
+                               const QVector<QStringList> &rows) {
+  QVector<int> widths;
+  for (const QString &header : headers) {
+    widths.append(header.size());
+  }
+  for (const QStringList &row : rows) {
+    for (int i = 0; i < row.size(); i += 1) {
+      widths[i] = qMax(widths.at(i), static_cast<int>(row.at(i).size()));
+    }
+  }
+  auto printRow = [&](const QStringList &row) {
+    QStringList cells;
+    for (int i = 0; i < row.size(); i += 1) {
+      cells.append(row.at(i).leftJustified(widths.at(i)));
+    }
+    QTextStream(stdout) << cells.join("  ").trimmed() << Qt::endl;
+  };
+  printRow(headers);
+  for (const QStringList &row : rows) {
+    printRow(row);
+  }
+}
+
+}  // namespace mms
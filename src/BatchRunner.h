@@ -0,0 +1,86 @@
+#pragma once
+
+#include <QMap>
+#include <QObject>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "WorkStealingScheduler.h"
+
+namespace mms {
+
+// Evaluates one or more mouse algorithms on every maze in a directory. Each
+// (algorithm, maze) pair is run by a separate headless worker process of this
+// executable, with up to a fixed number of workers running at once. A table of
+// the results is printed to stdout once every pair has been run, followed by a
+// leaderboard when there's more than one algorithm.
+//
+// In server mode, workers run the algorithms in HeadlessRunner's server mode
+// instead, and each slot keeps one worker per algorithm alive for as long as
+// there are mazes left, so each algorithm starts at most once per slot.
+class BatchRunner : public QObject {
+  Q_OBJECT
+
+ public:
+  BatchRunner(QObject *parent = nullptr);
+  ~BatchRunner();
+
+  // Returns false (after printing the reason) if the batch couldn't be started.
+  // A timeout of zero means that workers are never killed.
+  bool start(const QString &mazeDirectory, const QStringList &mouseAlgos,
+             int numWorkers, int timeoutSeconds, bool sharedMemory,
+             bool server);
+
+ signals:
+  // Emitted once every maze has been run; exitCode is zero if all were solved
+  void finished(int exitCode);
+
+ private:
+  struct MouseAlgo {
+    QString name;
+    QString runCommand;
+    QString directory;
+  };
+
+  struct Result {
+    int mouseAlgo;
+    QString mazePath;
+    QString status;
+    QMap<QString, QString> summary;
+  };
+
+  QVector<MouseAlgo> m_mouseAlgos;
+  int m_timeoutSeconds;
+  bool m_sharedMemory;
+
+  QVector<Result> m_results;
+  WorkStealingScheduler *m_scheduler;
+  QVector<QProcess *> m_workers;  // One slot per worker, null when idle
+
+  // Server mode, per slot: a worker per algorithm (null until it's needed),
+  // the job in progress (-1 when idle), and that job's output so far
+  bool m_isServer;
+  QVector<QVector<QProcess *>> m_servers;
+  QVector<int> m_serverJobs;
+  QVector<QByteArray> m_serverOutput;
+
+  bool isDone() const;
+  void finish();
+  void startWorker(int slot);
+  void onWorkerExit(int slot, int index);
+  void startServerJob(int slot);
+  QProcess *startServer(int slot, int mouseAlgo);
+  void onServerOutput(int slot, QProcess *server);
+  void onServerExit(int slot, int mouseAlgo);
+  void finishServerJob(int slot, const QByteArray &output);
+  void printTable() const;
+  void printLeaderboard() const;
+
+  // Pads every column to its widest cell
+  static void printColumns(const QStringList &headers,
+                           const QVector<QStringList> &rows);
+};
+
+}  // namespace mms
@@ -0,0 +1,226 @@
+#include "BinaryProtocol.h"
+
+#include <QtEndian>
+
+#include "Color.h"
+#include "Direction.h"
+#include "Stats.h"
+
+namespace mms {
+
+const char BinaryProtocol::FALSE_BYTE = 0x00;
+const char BinaryProtocol::TRUE_BYTE = 0x01;
+const char BinaryProtocol::ACK_BYTE = 0x02;
+const char BinaryProtocol::CRASH_BYTE = 0x03;
+
+int BinaryProtocol::decode(const char *data, int size, Command *command) {
+  if (size < 1) {
+    return 0;
+  }
+  const uchar *bytes = reinterpret_cast<const uchar *>(data);
+  *command = Command();
+  CommandType type = static_cast<CommandType>(bytes[0]);
+
+  // Readers for the fixed-size arguments that follow the opcode
+  auto int16At = [&](int offset) {
+    return static_cast<int>(qFromLittleEndian<qint16>(bytes + offset));
+  };
+  auto cellAt = [&](int offset) {
+    command->x = int16At(offset);
+    command->y = int16At(offset + 2);
+  };
+  auto uint16At = [&](int offset) {
+    return static_cast<int>(qFromLittleEndian<quint16>(bytes + offset));
+  };
+
+  switch (type) {
+    case CommandType::MAZE_WIDTH:
+    case CommandType::MAZE_HEIGHT:
+    case CommandType::TURN_RIGHT_90:
+    case CommandType::TURN_LEFT_90:
+    case CommandType::TURN_RIGHT_45:
+    case CommandType::TURN_LEFT_45:
+    case CommandType::CLEAR_ALL_COLOR:
+    case CommandType::CLEAR_ALL_TEXT:
+    case CommandType::WAS_RESET:
+    case CommandType::ACK_RESET:
+    case CommandType::SUBSCRIBE:
+    case CommandType::MOVE_UNTIL_WALL:
+    case CommandType::END_RUN:
+    case CommandType::USE_SENSING:
+      command->type = type;
+      return 1;
+    case CommandType::WALL_FRONT:
+    case CommandType::WALL_BACK:
+    case CommandType::WALL_LEFT:
+    case CommandType::WALL_RIGHT:
+    case CommandType::WALL_FRONT_RIGHT:
+    case CommandType::WALL_FRONT_LEFT:
+    case CommandType::WALL_BACK_RIGHT:
+    case CommandType::WALL_BACK_LEFT:
+    case CommandType::WALLS:
+    case CommandType::MOVE_FORWARD:
+    case CommandType::MOVE_FORWARD_HALF:
+      if (size < 3) {
+        return 0;
+      }
+      command->type = type;
+      command->n = int16At(1);
+      return 3;
+    case CommandType::MOVE_UNTIL_OPENING:
+      if (size < 2) {
+        return 0;
+      }
+      if (data[1] == 'L' || data[1] == 'R' || data[1] == 'A') {
+        command->type = type;
+        command->c = QChar::fromLatin1(data[1]);
+      }
+      return 2;
+    case CommandType::GET_STAT:
+      if (size < 2) {
+        return 0;
+      }
+      if (bytes[1] <= static_cast<uchar>(StatsEnum::SCORE)) {
+        command->type = type;
+        command->n = bytes[1];
+      }
+      return 2;
+    case CommandType::CLEAR_COLOR:
+    case CommandType::CLEAR_TEXT:
+      if (size < 5) {
+        return 0;
+      }
+      command->type = type;
+      cellAt(1);
+      return 5;
+    case CommandType::SET_WALL:
+    case CommandType::CLEAR_WALL:
+    case CommandType::SET_COLOR: {
+      if (size < 6) {
+        return 0;
+      }
+      QChar c = QChar::fromLatin1(data[5]);
+      bool valid = type == CommandType::SET_COLOR
+                       ? CHAR_TO_COLOR().contains(c)
+                       : CHAR_TO_DIRECTION().contains(c);
+      if (valid) {
+        command->type = type;
+        command->c = c;
+        cellAt(1);
+      }
+      return 6;
+    }
+    case CommandType::SET_TEXT: {
+      if (size < 6 || size < 6 + bytes[5]) {
+        return 0;
+      }
+      command->type = type;
+      cellAt(1);
+      command->text = QString::fromUtf8(data + 6, bytes[5]);
+      return 6 + bytes[5];
+    }
+    case CommandType::MARK:
+    case CommandType::SPAN_BEGIN:
+    case CommandType::SPAN_END:
+      if (size < 2 || size < 2 + bytes[1]) {
+        return 0;
+      }
+      // Labels can't be empty
+      if (bytes[1] > 0) {
+        command->type = type;
+        command->text = QString::fromUtf8(data + 2, bytes[1]);
+      }
+      return 2 + bytes[1];
+    case CommandType::SET_COLORS:
+    case CommandType::SET_TEXTS: {
+      if (size < 11 || size < 11 + uint16At(9)) {
+        return 0;
+      }
+      command->type = type;
+      cellAt(1);
+      command->width = int16At(5);
+      command->height = int16At(7);
+      command->text = QString::fromUtf8(data + 11, uint16At(9));
+      return 11 + uint16At(9);
+    }
+    case CommandType::SET_WALLS:
+      if (size < 3 || size < 3 + uint16At(1)) {
+        return 0;
+      }
+      command->type = type;
+      command->text = QString::fromLatin1(data + 3, uint16At(1));
+      return 3 + uint16At(1);
+    case CommandType::MOVES:
+    case CommandType::MOVES_SUMMARY: {
+      if (size < 2) {
+        return 0;
+      }
+      // The script is a sequence of ordinary movement commands. The opcode
+      // of each one is checked before it's decoded, so that a script can't
+      // nest another one (which would recurse without bound) and is never
+      // more than a few hundred bytes, however often it's decoded again while
+      // the rest of it arrives. Anything else ends the script, which is then
+      // invalid, and is left to be decoded as a command of its own.
+      QVector<Motion> motions;
+      bool isValid = true;
+      int offset = 2;
+      for (int i = 0; i < bytes[1]; i += 1) {
+        if (offset == size) {
+          return 0;
+        }
+        if (!isMotion(static_cast<CommandType>(bytes[offset]))) {
+          isValid = false;
+          break;
+        }
+        Command motion;
+        int consumed = decode(data + offset, size - offset, &motion);
+        if (consumed == 0) {
+          return 0;
+        }
+        offset += consumed;
+        motions.append({motion.type, motion.n});
+      }
+      if (isValid && !motions.isEmpty()) {
+        command->type = type;
+        command->motions = motions;
+      }
+      return offset;
+    }
+    default:
+      // Unknown opcode, skip just the one byte
+      return 1;
+  }
+}
+
+QByteArray BinaryProtocol::encode(const Response &response) {
+  switch (response.type) {
+    case ResponseType::ACK:
+      return QByteArray(1, ACK_BYTE);
+    case ResponseType::ACK_WALLS: {
+      QByteArray bytes(1, ACK_BYTE);
+      bytes.append(static_cast<char>(response.value));
+      return bytes;
+    }
+    case ResponseType::CRASH:
+      return QByteArray(1, CRASH_BYTE);
+    case ResponseType::BOOLEAN:
+      return QByteArray(1, response.value ? TRUE_BYTE : FALSE_BYTE);
+    case ResponseType::WALLS:
+      return QByteArray(1, static_cast<char>(response.value));
+    case ResponseType::INTEGER: {
+      QByteArray bytes(4, 0);
+      qToLittleEndian<qint32>(response.value, bytes.data());
+      return bytes;
+    }
+    case ResponseType::STAT: {
+      float value = response.text.isEmpty() ? -1.0f : response.text.toFloat();
+      QByteArray bytes(4, 0);
+      qToLittleEndian<float>(value, bytes.data());
+      return bytes;
+    }
+    default:
+      return QByteArray();
+  }
+}
+
+}  // namespace mms
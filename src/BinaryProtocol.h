@@ -0,0 +1,78 @@
+#pragma once
+
+#include <QByteArray>
+
+#include "Command.h"
+
+namespace mms {
+
+// An optional compact protocol, enabled by sending "useBinaryProtocol" as a
+// text command. Each command is a one-byte opcode (the CommandType value)
+// followed by fixed-size little-endian arguments, and is answered with:
+//
+//   opcode       command                 arguments            response
+//   0x01, 0x02   mazeWidth, mazeHeight   -                    int32
+//   0x10-0x17    wallFront, etc.         int16 halfStepsAway  bool
+//   0x18         walls                   int16 halfStepsAway  wall bits
+//   0x20         moveForward             int16 distance       ack
+//   0x21         moveForwardHalf         int16 halfSteps      ack
+//   0x22-0x25    turnRight, etc.         -                    ack
+//   0x26         moves                   uint8 count, count   ack per motion
+//                                        of 0x20-0x25 above
+//                                        (anything else ends
+//                                        the script, which is
+//                                        then dropped)
+//   0x27         movesSummary            same as moves        int32
+//   0x28         moveUntilWall           -                    int32
+//   0x29         moveUntilOpening        uint8 side (L/R/A)   int32
+//   0x30, 0x31   setWall, clearWall      int16 x, int16 y,    none
+//                                        uint8 direction
+//   0x32         setColor                int16 x, int16 y,    none
+//                                        uint8 color
+//   0x33, 0x36   clearColor, clearText   int16 x, int16 y     none
+//   0x34, 0x37   clearAll{Color,Text}    -                    none
+//   0x35         setText                 int16 x, int16 y,    none
+//                                        uint8 length, bytes
+//   0x38, 0x39   setColors, setTexts     int16 x, int16 y,    none
+//                                        int16 width, int16
+//                                        height, uint16
+//                                        length, bytes
+//   0x3A         setWalls                uint16 length, bytes none
+//   0x40         wasReset                -                    bool
+//   0x41         ackReset                -                    ack
+//   0x42         subscribe               -                    bool (false)
+//   0x50         getStat                 uint8 StatsEnum      float32
+//   0x51         mark                    uint8 length, bytes  none
+//   0x52, 0x53   span begin, span end    uint8 length, bytes  none
+//   0x60         endRun                  -                    "endRun\n"
+//   0x70         useSensing              -                    ack
+//
+// A bool is one byte, FALSE_BYTE or TRUE_BYTE, and wall bits are one byte,
+// see SimulationEngine::walls. An ack is the single ACK_BYTE, except that once
+// useSensing has been sent, the ack of a movement (including each motion of
+// moves) is two bytes: ACK_BYTE followed by the wall bits where it ended up.
+// Any movement can instead be answered with the single CRASH_BYTE, in which
+// case the rest of a moves script is answered with CRASH_BYTE too. An int32
+// is four bytes, as is a float32 (-1 if the stat is empty). endRun is
+// answered in text, by the server mode runner. Events aren't pushed, since
+// nothing would tell them apart from responses, so subscribe is refused.
+class BinaryProtocol {
+ public:
+  // The BinaryProtocol class is not constructible
+  BinaryProtocol() = delete;
+
+  static const char FALSE_BYTE;
+  static const char TRUE_BYTE;
+  static const char ACK_BYTE;
+  static const char CRASH_BYTE;
+
+  // Decodes the command at the front of the data and returns the number of
+  // bytes it took up, or zero if the data ends before the command does. An
+  // unknown opcode takes up one byte and decodes as INVALID.
+  static int decode(const char *data, int size, Command *command);
+
+  // Returns the response bytes, or nothing for responses that aren't sent
+  static QByteArray encode(const Response &response);
+};
+
+}  // namespace mms
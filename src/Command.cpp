@@ -0,0 +1,31 @@
+#include "Command.h"
+
+namespace mms {
+
+bool isMotion(CommandType type) {
+  switch (type) {
+    case CommandType::MOVE_FORWARD:
+    case CommandType::MOVE_FORWARD_HALF:
+    case CommandType::TURN_RIGHT_90:
+    case CommandType::TURN_LEFT_90:
+    case CommandType::TURN_RIGHT_45:
+    case CommandType::TURN_LEFT_45:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool isMovement(CommandType type) {
+  switch (type) {
+    case CommandType::MOVES:
+    case CommandType::MOVES_SUMMARY:
+    case CommandType::MOVE_UNTIL_WALL:
+    case CommandType::MOVE_UNTIL_OPENING:
+      return true;
+    default:
+      return isMotion(type);
+  }
+}
+
+}  // namespace mms
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <QChar>
+#include <QString>
+#include <QVector>
+
+namespace mms {
+
+// Every command that an algorithm can send. The values double as the opcodes
+// of the binary protocol, so they must never change.
+enum class CommandType : unsigned char {
+  INVALID = 0x00,
+
+  MAZE_WIDTH = 0x01,
+  MAZE_HEIGHT = 0x02,
+
+  WALL_FRONT = 0x10,
+  WALL_BACK = 0x11,
+  WALL_LEFT = 0x12,
+  WALL_RIGHT = 0x13,
+  WALL_FRONT_RIGHT = 0x14,
+  WALL_FRONT_LEFT = 0x15,
+  WALL_BACK_RIGHT = 0x16,
+  WALL_BACK_LEFT = 0x17,
+  WALLS = 0x18,
+
+  MOVE_FORWARD = 0x20,
+  MOVE_FORWARD_HALF = 0x21,
+  TURN_RIGHT_90 = 0x22,
+  TURN_LEFT_90 = 0x23,
+  TURN_RIGHT_45 = 0x24,
+  TURN_LEFT_45 = 0x25,
+  MOVES = 0x26,
+  MOVES_SUMMARY = 0x27,
+  MOVE_UNTIL_WALL = 0x28,
+  MOVE_UNTIL_OPENING = 0x29,
+
+  SET_WALL = 0x30,
+  CLEAR_WALL = 0x31,
+  SET_COLOR = 0x32,
+  CLEAR_COLOR = 0x33,
+  CLEAR_ALL_COLOR = 0x34,
+  SET_TEXT = 0x35,
+  CLEAR_TEXT = 0x36,
+  CLEAR_ALL_TEXT = 0x37,
+  SET_COLORS = 0x38,
+  SET_TEXTS = 0x39,
+  SET_WALLS = 0x3A,
+
+  WAS_RESET = 0x40,
+  ACK_RESET = 0x41,
+
+  // Events are pushed as text lines, so the binary protocol refuses this
+  SUBSCRIBE = 0x42,
+
+  GET_STAT = 0x50,
+
+  // Profiling markers, timestamped on arrival and shown on the run timeline
+  MARK = 0x51,
+  SPAN_BEGIN = 0x52,
+  SPAN_END = 0x53,
+
+  // Server mode only, the algorithm is done with the current maze
+  END_RUN = 0x60,
+
+  // Every movement ack from then on carries the walls around the mouse
+  USE_SENSING = 0x70,
+
+  // Only valid in the text protocol, switches both directions to binary
+  USE_BINARY_PROTOCOL = 0x7F,
+};
+
+// Whether the command is a single movement, the kind that motion scripts are
+// made of
+bool isMotion(CommandType type);
+
+// Whether the command moves the mouse, which also includes scripts and the
+// compound movements
+bool isMovement(CommandType type);
+
+// One step of a motion script, a movement command and its distance
+struct Motion {
+  CommandType type = CommandType::INVALID;
+  int n = 1;
+};
+
+// A parsed command, independent of the protocol it arrived in. Only the
+// fields used by the command's type are meaningful.
+struct Command {
+  CommandType type = CommandType::INVALID;
+  int x = 0;  // Cell coordinates of visualization commands
+  int y = 0;
+  int width = 0;  // Size of the rectangle of setColors and setTexts
+  int height = 0;
+  int n = 1;    // Distance, half-steps away, or StatsEnum value
+  QChar c;      // Direction, color, or side (L, R, or A for any) character
+  QString text;  // Text of setText, a marker label, or a bulk payload
+  QVector<Motion> motions;  // Script of moves and movesSummary
+  qint64 arrivalMicros = 0;  // When the engine received it, see CommandLatency
+};
+
+// The result of executing a serial command
+enum class ResponseType {
+  PENDING,  // A movement has started, the response comes once it's done
+  ACK,
+  ACK_WALLS,  // An ack of a movement, with the walls where it ended up
+  CRASH,
+  INVALID,  // Nothing is sent, e.g., invalid commands are dropped on the floor
+  BOOLEAN,
+  INTEGER,
+  WALLS,  // A bitmask of wall directions, see SimulationEngine::walls
+  STAT,  // The text of a stat, or -1 if it's empty
+  EVENT,  // Unsolicited, the text is the name of the event
+};
+
+struct Response {
+  ResponseType type = ResponseType::INVALID;
+  int value = 0;
+  QString text;
+};
+
+}  // namespace mms
@@ -0,0 +1,170 @@
+#include "CommandLatency.h"
+
+#include <QStringList>
+
+#include "TextProtocol.h"
+
+namespace mms {
+
+const int LatencyHistogram::NUM_BUCKETS = 32;
+
+LatencyHistogram::LatencyHistogram()
+    : m_buckets(QVector<qint64>(NUM_BUCKETS, 0)),
+      m_count(0),
+      m_totalMicros(0),
+      m_maxMicros(0) {}
+
+void LatencyHistogram::add(qint64 micros) {
+  // The bucket is the number of significant bits
+  int bucket = 0;
+  while (bucket < NUM_BUCKETS - 1 && (micros >> bucket) > 0) {
+    bucket += 1;
+  }
+  m_buckets[bucket] += 1;
+  m_count += 1;
+  m_totalMicros += micros;
+  m_maxMicros = qMax(m_maxMicros, micros);
+}
+
+qint64 LatencyHistogram::getCount() const { return m_count; }
+
+qint64 LatencyHistogram::getTotalMicros() const { return m_totalMicros; }
+
+qint64 LatencyHistogram::getMaxMicros() const { return m_maxMicros; }
+
+qint64 LatencyHistogram::getBucketCount(int bucket) const {
+  return m_buckets.at(bucket);
+}
+
+qint64 LatencyHistogram::getPercentileMicros(double fraction) const {
+  qint64 rank = static_cast<qint64>(fraction * m_count);
+  qint64 seen = 0;
+  for (int bucket = 0; bucket < NUM_BUCKETS; bucket += 1) {
+    seen += m_buckets.at(bucket);
+    if (seen > rank) {
+      return qMin(getBucketLimitMicros(bucket), m_maxMicros);
+    }
+  }
+  return m_maxMicros;
+}
+
+qint64 LatencyHistogram::getBucketLimitMicros(int bucket) {
+  return static_cast<qint64>(1) << bucket;
+}
+
+CommandLatency::CommandLatency()
+    : m_serviceTimes(QMap<CommandType, LatencyHistogram>()),
+      m_thinkTimes(QMap<CommandType, LatencyHistogram>()) {}
+
+void CommandLatency::clear() {
+  m_serviceTimes.clear();
+  m_thinkTimes.clear();
+}
+
+void CommandLatency::addServiceTime(CommandType type, qint64 micros) {
+  m_serviceTimes[type].add(micros);
+}
+
+void CommandLatency::addThinkTime(CommandType type, qint64 micros) {
+  m_thinkTimes[type].add(micros);
+}
+
+qint64 CommandLatency::getTotalServiceMicros() const {
+  return total(m_serviceTimes);
+}
+
+qint64 CommandLatency::getTotalThinkMicros() const {
+  return total(m_thinkTimes);
+}
+
+LatencyHistogram CommandLatency::getServiceTimes(CommandType type) const {
+  return m_serviceTimes.value(type);
+}
+
+LatencyHistogram CommandLatency::getThinkTimes(CommandType type) const {
+  return m_thinkTimes.value(type);
+}
+
+QString CommandLatency::toTable() const {
+  auto formatMicros = [](qint64 micros) {
+    if (micros < 1000) {
+      return QString("%1us").arg(micros);
+    }
+    if (micros < 1000000) {
+      return QString::number(micros / 1e3, 'f', 1) + "ms";
+    }
+    return QString::number(micros / 1e6, 'f', 2) + "s";
+  };
+  auto formatColumns = [&](const LatencyHistogram &histogram) {
+    QString columns;
+    for (qint64 micros : {histogram.getPercentileMicros(0.5),
+                          histogram.getPercentileMicros(0.99),
+                          histogram.getMaxMicros(),
+                          histogram.getTotalMicros()}) {
+      columns += formatMicros(micros).rightJustified(9);
+    }
+    return columns;
+  };
+
+  QString columns = "      p50      p99      max    total";
+  QString table = QString(26, ' ') + QString("service").leftJustified(36) +
+                  "think\n" + QString("command").leftJustified(18) +
+                  QString("count").rightJustified(8) + columns + columns + "\n";
+  for (CommandType type : types()) {
+    LatencyHistogram service = m_serviceTimes.value(type);
+    table += QString::fromLatin1(TextProtocol::commandName(type))
+                 .leftJustified(18) +
+             QString::number(service.getCount()).rightJustified(8) +
+             formatColumns(service) +
+             formatColumns(m_thinkTimes.value(type)) + "\n";
+  }
+  return table;
+}
+
+QString CommandLatency::toCsv() const {
+  QStringList header;
+  header << "command" << "kind" << "count" << "total_us" << "max_us";
+  int last = LatencyHistogram::NUM_BUCKETS - 1;
+  for (int bucket = 0; bucket < last; bucket += 1) {
+    header << QString("lt_%1us").arg(
+        LatencyHistogram::getBucketLimitMicros(bucket));
+  }
+  header << QString("ge_%1us").arg(
+      LatencyHistogram::getBucketLimitMicros(last - 1));
+
+  QString csv = header.join(",") + "\n";
+  for (CommandType type : types()) {
+    for (bool isService : {true, false}) {
+      const LatencyHistogram histogram = isService
+                                             ? m_serviceTimes.value(type)
+                                             : m_thinkTimes.value(type);
+      QStringList row;
+      row << QString::fromLatin1(TextProtocol::commandName(type))
+          << (isService ? "service" : "think")
+          << QString::number(histogram.getCount())
+          << QString::number(histogram.getTotalMicros())
+          << QString::number(histogram.getMaxMicros());
+      for (int bucket = 0; bucket <= last; bucket += 1) {
+        row << QString::number(histogram.getBucketCount(bucket));
+      }
+      csv += row.join(",") + "\n";
+    }
+  }
+  return csv;
+}
+
+QList<CommandType> CommandLatency::types() const {
+  // Anything with a think time was answered, so it has a service time too
+  return m_serviceTimes.keys();
+}
+
+qint64 CommandLatency::total(
+    const QMap<CommandType, LatencyHistogram> &histograms) {
+  qint64 micros = 0;
+  for (const LatencyHistogram &histogram : histograms) {
+    micros += histogram.getTotalMicros();
+  }
+  return micros;
+}
+
+}  // namespace mms
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+#include "Command.h"
+
+namespace mms {
+
+// Counts durations in power-of-two buckets of microseconds: bucket 0 holds
+// durations under a microsecond, bucket i holds [2^(i-1), 2^i), and the last
+// bucket also holds anything longer
+class LatencyHistogram {
+ public:
+  static const int NUM_BUCKETS;
+
+  LatencyHistogram();
+  void add(qint64 micros);
+
+  qint64 getCount() const;
+  qint64 getTotalMicros() const;
+  qint64 getMaxMicros() const;
+  qint64 getBucketCount(int bucket) const;
+
+  // The upper bound of the bucket that holds the given fraction of samples,
+  // never more than the largest sample
+  qint64 getPercentileMicros(double fraction) const;
+
+  // The exclusive upper bound of a bucket
+  static qint64 getBucketLimitMicros(int bucket);
+
+ private:
+  QVector<qint64> m_buckets;
+  qint64 m_count;
+  qint64 m_totalMicros;
+  qint64 m_maxMicros;
+};
+
+// Splits the time of a run into the simulator's service time, from a command
+// arriving to its response being written, and the algorithm's think time,
+// from a response being written to the next command arriving. Both are kept
+// per command type, with think time going to the command that was answered.
+class CommandLatency {
+ public:
+  CommandLatency();
+  void clear();
+
+  void addServiceTime(CommandType type, qint64 micros);
+  void addThinkTime(CommandType type, qint64 micros);
+
+  qint64 getTotalServiceMicros() const;
+  qint64 getTotalThinkMicros() const;
+
+  // Empty for types that were never answered
+  LatencyHistogram getServiceTimes(CommandType type) const;
+  LatencyHistogram getThinkTimes(CommandType type) const;
+
+  // A summary with a row per command type, for a fixed-width font
+  QString toTable() const;
+
+  // Every bucket of every histogram, with a header row
+  QString toCsv() const;
+
+ private:
+  QMap<CommandType, LatencyHistogram> m_serviceTimes;
+  QMap<CommandType, LatencyHistogram> m_thinkTimes;
+
+  QList<CommandType> types() const;
+  static qint64 total(const QMap<CommandType, LatencyHistogram> &histograms);
+};
+
+}  // namespace mms
@@ -1,9 +1,18 @@
 #include "Driver.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QSurfaceFormat>
+#include <QTextStream>
+#include <QThread>
+#include <cstring>
 
 #include "AssertMacros.h"
+#include "BatchRunner.h"
 #include "ColorManager.h"
+#include "HeadlessRunner.h"
 #include "Logging.h"
 #include "Settings.h"
 #include "Window.h"
@@ -14,6 +23,19 @@ int Driver::drive(int argc, char *argv[]) {
   // Make sure that this function is called just once
   ASSERT_RUNS_JUST_ONCE();
 
+  // Skip all graphics if requested
+  if (isHeadless(argc, argv)) {
+    return driveHeadless(argc, argv);
+  }
+
+  // Present frames at vsync; the map only ever draws the latest state,
+  // so at max speed intermediate movements are simply never shown. A swap
+  // interval of 1 is already Qt's default, it's pinned here on purpose so
+  // that max speed doesn't depend on that default.
+  QSurfaceFormat format = QSurfaceFormat::defaultFormat();
+  format.setSwapInterval(1);
+  QSurfaceFormat::setDefaultFormat(format);
+
   // Initialize Qt
   QApplication app(argc, argv);
 
@@ -26,6 +48,196 @@ int Driver::drive(int argc, char *argv[]) {
   Window window;
   window.show();
 
+  // Replay a recorded run if requested
+  QString tracePath = replayPath(argc, argv);
+  if (!tracePath.isEmpty()) {
+    window.startReplay(tracePath);
+  }
+
+  // Start the event loop
+  return app.exec();
+}
+
+bool Driver::isHeadless(int argc, char *argv[]) {
+  // Checked before any Qt application object exists, since
+  // that determines which kind of application we create
+  for (int i = 1; i < argc; i += 1) {
+    if (std::strcmp(argv[i], "--headless") == 0 ||
+        std::strcmp(argv[i], "--batch") == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+QString Driver::replayPath(int argc, char *argv[]) {
+  // The window has no other options, so there's no need for a parser
+  for (int i = 1; i < argc - 1; i += 1) {
+    if (std::strcmp(argv[i], "--replay") == 0) {
+      return QString::fromLocal8Bit(argv[i + 1]);
+    }
+  }
+  return QString();
+}
+
+int Driver::driveHeadless(int argc, char *argv[]) {
+  // Initialize Qt, without any GUI support
+  QCoreApplication app(argc, argv);
+
+  // Initialize singletons
+  Logging::init();
+  Settings::init();
+
+  // Parse the command line
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Run a mouse algorithm without a window");
+  parser.addHelpOption();
+  QCommandLineOption headlessOption("headless", "Run without a window.");
+  QCommandLineOption mazeOption("maze", "The maze file to load.", "file");
+  QCommandLineOption algoOption("algo", "The command that runs the algorithm.",
+                                "cmd");
+  QCommandLineOption dirOption(
+      "dir", "The working directory of the algorithm (default: current).",
+      "path", QDir::currentPath());
+  QCommandLineOption batchOption(
+      "batch", "Run the algorithm on every maze in a directory.", "dir");
+  QCommandLineOption mouseOption(
+      "mouse",
+      "The name of a configured mouse algorithm (batch mode), repeat to rank "
+      "several algorithms against each other.",
+      "name");
+  QCommandLineOption jobsOption(
+      "jobs", "The number of mazes to run at once (default: CPU count).",
+      "n", QString::number(QThread::idealThreadCount()));
+  QCommandLineOption timeoutOption(
+      "timeout", "Seconds before a single maze run is killed (default: none).",
+      "seconds", "0");
+  QCommandLineOption shmOption(
+      "shm",
+      "Also offer the algorithm shared memory rings for commands and "
+      "responses, see SharedMemoryRing.h.");
+  QCommandLineOption serverOption(
+      "server",
+      "Keep the algorithm running across mazes, which are read from stdin "
+      "(or taken from --batch), see the README.");
+  QCommandLineOption traceOption(
+      "trace", "Record the run to a trace file, see --replay.", "file");
+  QCommandLineOption replayOption(
+      "replay", "Replay a trace file instead of running an algorithm.",
+      "file");
+  QCommandLineOption latencyOption(
+      "latency",
+      "Write histograms of the simulator's and the algorithm's time per "
+      "command to a CSV file.",
+      "file");
+  QCommandLineOption timelineOption(
+      "timeline",
+      "Write the run's movements and the algorithm's mark and span markers "
+      "to a JSON file for chrome://tracing or Perfetto.",
+      "file");
+  parser.addOption(headlessOption);
+  parser.addOption(mazeOption);
+  parser.addOption(algoOption);
+  parser.addOption(dirOption);
+  parser.addOption(batchOption);
+  parser.addOption(mouseOption);
+  parser.addOption(jobsOption);
+  parser.addOption(timeoutOption);
+  parser.addOption(shmOption);
+  parser.addOption(serverOption);
+  parser.addOption(traceOption);
+  parser.addOption(replayOption);
+  parser.addOption(latencyOption);
+  parser.addOption(timelineOption);
+  parser.process(app);
+
+  if (parser.isSet(serverOption) && parser.isSet(shmOption)) {
+    QTextStream(stderr) << "--shm is ignored with --server" << Qt::endl;
+  }
+  for (const QCommandLineOption &option :
+       {traceOption, latencyOption, timelineOption}) {
+    if (parser.isSet(option) &&
+        (parser.isSet(batchOption) || parser.isSet(serverOption))) {
+      QTextStream(stderr) << "--" << option.names().first()
+                          << " is only used for single runs" << Qt::endl;
+    }
+  }
+
+  // Evaluate a configured algorithm on many mazes
+  if (parser.isSet(batchOption)) {
+    if (!parser.isSet(mouseOption)) {
+      QTextStream(stderr) << "--batch requires --mouse" << Qt::endl;
+      parser.showHelp(1);
+    }
+    BatchRunner runner;
+    QObject::connect(&runner, &BatchRunner::finished, &app,
+                     &QCoreApplication::exit, Qt::QueuedConnection);
+    if (!runner.start(parser.value(batchOption), parser.values(mouseOption),
+                      parser.value(jobsOption).toInt(),
+                      parser.value(timeoutOption).toInt(),
+                      parser.isSet(shmOption), parser.isSet(serverOption))) {
+      return 1;
+    }
+    return app.exec();
+  }
+
+  // Run the algorithm on every maze given on stdin, exit when it does
+  if (parser.isSet(serverOption)) {
+    if (!parser.isSet(algoOption)) {
+      QTextStream(stderr) << "--server requires --algo" << Qt::endl;
+      parser.showHelp(1);
+    }
+    HeadlessRunner runner;
+    QObject::connect(&runner, &HeadlessRunner::finished, &app,
+                     &QCoreApplication::exit, Qt::QueuedConnection);
+    if (!runner.startServer(parser.value(algoOption),
+                            parser.value(dirOption))) {
+      return 1;
+    }
+    return app.exec();
+  }
+
+  // Replay a recorded run, exit when it's done
+  if (parser.isSet(replayOption)) {
+    HeadlessRunner runner;
+    QObject::connect(&runner, &HeadlessRunner::finished, &app,
+                     &QCoreApplication::exit, Qt::QueuedConnection);
+    if (parser.isSet(latencyOption)) {
+      runner.setLatencyPath(parser.value(latencyOption));
+    }
+    if (parser.isSet(timelineOption)) {
+      runner.setTimelinePath(parser.value(timelineOption));
+    }
+    if (!runner.startReplay(parser.value(replayOption))) {
+      return 1;
+    }
+    return app.exec();
+  }
+
+  // Validation
+  if (!parser.isSet(mazeOption) || !parser.isSet(algoOption)) {
+    QTextStream(stderr) << "Both --maze and --algo are required" << Qt::endl;
+    parser.showHelp(1);
+  }
+
+  // Run the algorithm, exit when it does
+  HeadlessRunner runner;
+  QObject::connect(&runner, &HeadlessRunner::finished, &app,
+                   &QCoreApplication::exit, Qt::QueuedConnection);
+  if (parser.isSet(traceOption)) {
+    runner.setTracePath(parser.value(traceOption));
+  }
+  if (parser.isSet(latencyOption)) {
+    runner.setLatencyPath(parser.value(latencyOption));
+  }
+  if (parser.isSet(timelineOption)) {
+    runner.setTimelinePath(parser.value(timelineOption));
+  }
+  if (!runner.start(parser.value(mazeOption), parser.value(algoOption),
+                    parser.value(dirOption), parser.isSet(shmOption))) {
+    return 1;
+  }
+
   // Start the event loop
   return app.exec();
 }
@@ -1,11 +1,18 @@
 #pragma once
 
+#include <QString>
+
 namespace mms {
 
 class Driver {
  public:
   Driver() = delete;
   static int drive(int argc, char *argv[]);
+
+ private:
+  static bool isHeadless(int argc, char *argv[]);
+  static QString replayPath(int argc, char *argv[]);
+  static int driveHeadless(int argc, char *argv[]);
 };
 
 }  // namespace mms
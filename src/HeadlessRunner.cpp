@@ -0,0 +1,436 @@
+#include "HeadlessRunner.h"
+
+#include <QFile>
+#include <QPair>
+#include <QProcessEnvironment>
+#include <QTextStream>
+#include <QVector>
+#include <limits>
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+#include "AssertMacros.h"
+#include "ProcessUtilities.h"
+
+namespace mms {
+
+HeadlessRunner::HeadlessRunner(QObject *parent)
+    : QObject(parent),
+      m_maze(nullptr),
+      m_mazePath(QString()),
+      m_engine(new SimulationEngine(this)),
+      m_process(nullptr),
+      m_isServer(false),
+      m_mazePathsNotifier(nullptr),
+      m_mazePathSplitter(LineSplitter()),
+      m_mazePaths(QQueue<QString>()),
+      m_isEndOfMazePaths(false),
+      m_tracePath(QString()),
+      m_traceWriter(nullptr),
+      m_tracePlayer(nullptr),
+      m_latencyPath(QString()),
+      m_timelinePath(QString()) {}
+
+HeadlessRunner::~HeadlessRunner() {
+  if (m_process != nullptr) {
+    m_process->kill();
+    m_process->waitForFinished();
+  }
+  m_engine->stopRun();
+  m_engine->removeMouse();
+  delete m_traceWriter;
+  delete m_maze;
+}
+
+bool HeadlessRunner::start(const QString &mazePath, const QString &runCommand,
+                           const QString &directory, bool sharedMemory) {
+  // Only one run per runner
+  ASSERT_TR(m_process == nullptr);
+  QTextStream err(stderr);
+
+  if (!loadMaze(mazePath)) {
+    return false;
+  }
+
+  // Nobody is watching, so movements complete as fast as possible
+  m_engine->setRealTimeFactor(std::numeric_limits<double>::infinity());
+
+  // Instantiate a new process, pass its stderr straight through
+  QProcess *process = new QProcess(this);
+  process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+
+  // There's nothing to visualize, so there's no view
+  m_engine->setSharedMemoryEnabled(sharedMemory);
+  if (!m_tracePath.isEmpty()) {
+    m_traceWriter = new TraceWriter();
+    if (!m_traceWriter->open(m_tracePath, m_maze, mazePath)) {
+      err << "Can't write trace file: " << m_tracePath << Qt::endl;
+      delete process;
+      return false;
+    }
+    m_engine->setTraceWriter(m_traceWriter);
+  }
+  m_engine->startRun(process, nullptr);
+  m_engine->getStats()->resetAll();
+
+  // Tell the algorithm where to find the shared memory, if any
+  if (sharedMemory) {
+    QString name = m_engine->getSharedMemoryName();
+    if (name.isEmpty()) {
+      err << "Shared memory is unavailable, using stdin/stdout" << Qt::endl;
+    } else {
+      QProcessEnvironment environment =
+          QProcessEnvironment::systemEnvironment();
+      environment.insert(SharedMemoryTransport::NAME_VARIABLE, name);
+      process->setProcessEnvironment(environment);
+    }
+  }
+
+  // Process commands from stdout
+  connect(process, &QProcess::readyReadStandardOutput, this, [=]() {
+    m_engine->receiveCommands(process->readAllStandardOutput());
+  });
+
+  // Clean up on exit
+  connect(process,
+          static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(
+              &QProcess::finished),
+          this, &HeadlessRunner::onRunExit);
+
+  // Start the run process
+  if (!ProcessUtilities::start(runCommand, directory, process)) {
+    err << process->errorString() << Qt::endl;
+    m_engine->stopRun();
+    delete process;
+    return false;
+  }
+  m_process = process;
+  return true;
+}
+
+bool HeadlessRunner::startServer(const QString &runCommand,
+                                 const QString &directory) {
+  ASSERT_TR(m_process == nullptr);
+  m_isServer = true;
+  m_engine->setRealTimeFactor(std::numeric_limits<double>::infinity());
+
+  QProcess *process = new QProcess(this);
+  process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+
+  // Nothing should arrive between runs, and it's dropped if it does
+  connect(process, &QProcess::readyReadStandardOutput, this, [=]() {
+    QByteArray bytes = process->readAllStandardOutput();
+    if (m_maze != nullptr) {
+      m_engine->receiveCommands(bytes);
+    }
+  });
+
+  // Queued, since the engine is in the middle of processing commands
+  connect(m_engine, &SimulationEngine::runEnded, this,
+          &HeadlessRunner::onRunEnded, Qt::QueuedConnection);
+  connect(process,
+          static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(
+              &QProcess::finished),
+          this, &HeadlessRunner::onRunExit);
+
+  // Maze paths are read as they arrive; without a way to wait on stdin, they
+  // all have to be read before the algorithm starts
+#ifdef Q_OS_UNIX
+  m_mazePathsNotifier =
+      new QSocketNotifier(STDIN_FILENO, QSocketNotifier::Read, this);
+  connect(m_mazePathsNotifier, &QSocketNotifier::activated, this,
+          &HeadlessRunner::onMazePathsReadable);
+#else
+  QTextStream stream(stdin);
+  QString mazePath;
+  while (stream.readLineInto(&mazePath)) {
+    addMazePath(mazePath.toUtf8());
+  }
+  m_isEndOfMazePaths = true;
+#endif
+
+  if (!ProcessUtilities::start(runCommand, directory, process)) {
+    QTextStream(stderr) << process->errorString() << Qt::endl;
+    delete process;
+    return false;
+  }
+  m_process = process;
+  startNextRun();
+  return true;
+}
+
+void HeadlessRunner::setTracePath(const QString &tracePath) {
+  m_tracePath = tracePath;
+}
+
+void HeadlessRunner::setLatencyPath(const QString &latencyPath) {
+  m_latencyPath = latencyPath;
+}
+
+void HeadlessRunner::setTimelinePath(const QString &timelinePath) {
+  m_timelinePath = timelinePath;
+}
+
+bool HeadlessRunner::startReplay(const QString &tracePath) {
+  ASSERT_TR(m_process == nullptr);
+  RunTrace trace;
+  if (!RunTrace::read(tracePath, &trace)) {
+    QTextStream(stderr) << "Invalid trace file: " << tracePath << Qt::endl;
+    return false;
+  }
+  m_maze = trace.createMaze();
+  if (m_maze == nullptr) {
+    QTextStream(stderr) << "Invalid maze in trace file: " << tracePath
+                        << Qt::endl;
+    return false;
+  }
+  m_mazePath = trace.mazePath;
+  m_engine->setMaze(m_maze);
+  m_engine->setRealTimeFactor(std::numeric_limits<double>::infinity());
+
+  m_tracePlayer = new TracePlayer(m_engine, trace.records, this);
+  connect(m_tracePlayer, &TracePlayer::finished, this,
+          &HeadlessRunner::onReplayFinished);
+  m_tracePlayer->start(nullptr, false);
+  return true;
+}
+
+QStringList HeadlessRunner::workerArguments(const QString &mazePath,
+                                            const QString &runCommand,
+                                            const QString &directory,
+                                            bool sharedMemory) {
+  QStringList arguments = {"--headless", "--maze", mazePath, "--algo",
+                           runCommand,   "--dir",  directory};
+  if (sharedMemory) {
+    arguments.append("--shm");
+  }
+  return arguments;
+}
+
+QStringList HeadlessRunner::serverArguments(const QString &runCommand,
+                                            const QString &directory) {
+  return {"--headless", "--server", "--algo", runCommand, "--dir", directory};
+}
+
+QMap<QString, QString> HeadlessRunner::parseSummary(const QString &output) {
+  QMap<QString, QString> summary;
+  for (const QString &line : output.split("\n", Qt::SkipEmptyParts)) {
+    int space = line.indexOf(" ");
+    if (space < 1) {
+      continue;
+    }
+    summary.insert(line.left(space), line.mid(space + 1).trimmed());
+  }
+  return summary;
+}
+
+bool HeadlessRunner::loadMaze(const QString &mazePath) {
+  m_maze = Maze::fromFile(mazePath);
+  if (m_maze == nullptr) {
+    QTextStream(stderr) << "Invalid maze file: " << mazePath << Qt::endl;
+    return false;
+  }
+  m_mazePath = mazePath;
+  m_engine->setMaze(m_maze);
+  return true;
+}
+
+void HeadlessRunner::onMazePathsReadable() {
+#ifdef Q_OS_UNIX
+  char buffer[4096];
+  qint64 size = ::read(STDIN_FILENO, buffer, sizeof(buffer));
+  if (size < 0 && errno == EINTR) {
+    return;
+  }
+  if (size > 0) {
+    for (QByteArrayView line :
+         m_mazePathSplitter.split(QByteArrayView(buffer, size))) {
+      addMazePath(line);
+    }
+  } else {
+    // The last path might not end with a newline
+    for (QByteArrayView line : m_mazePathSplitter.split("\n")) {
+      addMazePath(line);
+    }
+    m_isEndOfMazePaths = true;
+    m_mazePathsNotifier->setEnabled(false);
+  }
+
+  // Only if the algorithm is waiting on the next maze
+  if (m_maze == nullptr && m_process != nullptr) {
+    startNextRun();
+  }
+#endif
+}
+
+void HeadlessRunner::addMazePath(QByteArrayView line) {
+  if (!line.isEmpty()) {
+    m_mazePaths.enqueue(QString::fromUtf8(line));
+  }
+}
+
+void HeadlessRunner::startNextRun() {
+  while (!m_mazePaths.isEmpty()) {
+    QString mazePath = m_mazePaths.dequeue();
+    if (!loadMaze(mazePath)) {
+      QTextStream(stdout) << "maze " << mazePath << Qt::endl
+                          << "status FAILED" << Qt::endl
+                          << Qt::endl;
+      continue;
+    }
+    // Each run starts over in the text protocol
+    m_engine->startRun(m_process, nullptr);
+    m_engine->getStats()->resetAll();
+    m_process->write(QString("newRun %1 %2\n")
+                         .arg(m_maze->getWidth())
+                         .arg(m_maze->getHeight())
+                         .toUtf8());
+    return;
+  }
+
+  // No more mazes, so the algorithm should exit; otherwise, the next path
+  // starts the next run once it arrives
+  if (m_isEndOfMazePaths) {
+    m_process->closeWriteChannel();
+  }
+}
+
+void HeadlessRunner::onRunEnded() {
+  // The algorithm might have exited in the meantime
+  if (m_process == nullptr) {
+    return;
+  }
+  m_engine->stopRun();
+  printSummary(true);
+  QTextStream(stdout) << Qt::endl;
+
+  m_engine->removeMouse();
+  m_engine->setMaze(nullptr);
+  delete m_maze;
+  m_maze = nullptr;
+
+  m_process->write("endRun\n");
+  startNextRun();
+}
+
+void HeadlessRunner::onRunExit(int exitCode, QProcess::ExitStatus exitStatus) {
+  // Stop consuming queued commands
+  m_engine->stopRun();
+  m_engine->setTraceWriter(nullptr);
+  if (m_traceWriter != nullptr) {
+    m_traceWriter->close();
+  }
+
+  // In server mode, only a run that's cut short by the exit is reported
+  bool complete = exitStatus == QProcess::NormalExit && exitCode == 0;
+  if (m_isServer) {
+    if (m_maze != nullptr) {
+      printSummary(false);
+      QTextStream(stdout) << Qt::endl;
+      complete = false;
+    }
+  } else {
+    printSummary(complete);
+    writeLatency();
+    writeTimeline();
+  }
+
+  // Clean up (stop producing commands)
+  m_process->deleteLater();
+  m_process = nullptr;
+
+  emit finished(complete ? 0 : 1);
+}
+
+void HeadlessRunner::onReplayFinished() {
+  m_engine->stopRun();
+
+  // The replay is only faithful if the engine answered exactly as recorded
+  int numDivergences = m_tracePlayer->getNumDivergences();
+  if (numDivergences > 0) {
+    QTextStream(stderr) << "Replay diverged from the trace " << numDivergences
+                        << " time(s)" << Qt::endl;
+  }
+  printSummary(numDivergences == 0);
+  writeLatency();
+  writeTimeline();
+  emit finished(numDivergences == 0 ? 0 : 1);
+}
+
+void HeadlessRunner::printSummary(bool complete) {
+  static const QVector<QPair<QString, StatsEnum>> stats = {
+      {"total-distance", StatsEnum::TOTAL_DISTANCE},
+      {"total-turns", StatsEnum::TOTAL_TURNS},
+      {"total-effective-distance", StatsEnum::TOTAL_EFFECTIVE_DISTANCE},
+      {"best-run-distance", StatsEnum::BEST_RUN_DISTANCE},
+      {"best-run-turns", StatsEnum::BEST_RUN_TURNS},
+      {"best-run-effective-distance", StatsEnum::BEST_RUN_EFFECTIVE_DISTANCE},
+      {"current-run-distance", StatsEnum::CURRENT_RUN_DISTANCE},
+      {"current-run-turns", StatsEnum::CURRENT_RUN_TURNS},
+      {"current-run-effective-distance",
+       StatsEnum::CURRENT_RUN_EFFECTIVE_DISTANCE},
+      {"score", StatsEnum::SCORE},
+  };
+
+  // One "key value" pair per line, easy to parse from scripts
+  QTextStream out(stdout);
+  out << "maze " << m_mazePath << Qt::endl;
+  out << "status " << (complete ? "COMPLETE" : "FAILED") << Qt::endl;
+  out << "solved " << (m_engine->getStats()->isSolved() ? "true" : "false")
+      << Qt::endl;
+  for (const auto &pair : stats) {
+    QString value = m_engine->getStats()->getStat(pair.second);
+    out << pair.first << " " << (value.isEmpty() ? "-1" : value) << Qt::endl;
+  }
+  out << "robot-time " << QString::number(m_engine->getClock()->now(), 'f', 3)
+      << Qt::endl;
+
+  // Simulator overhead, as opposed to time spent in the algorithm
+  qint64 numCommands = m_engine->getNumCommands();
+  double cpuSeconds = m_engine->getCommandCpuSeconds();
+  out << "commands " << numCommands << Qt::endl;
+  out << "cpu-per-command-us "
+      << QString::number(
+             numCommands > 0 ? cpuSeconds * 1e6 / numCommands : 0.0, 'f', 3)
+      << Qt::endl;
+
+  // Wall-clock time spent answering commands, and waiting for the next one
+  const CommandLatency *latency = m_engine->getLatency();
+  out << "service-seconds "
+      << QString::number(latency->getTotalServiceMicros() / 1e6, 'f', 3)
+      << Qt::endl;
+  out << "think-seconds "
+      << QString::number(latency->getTotalThinkMicros() / 1e6, 'f', 3)
+      << Qt::endl;
+}
+
+void HeadlessRunner::writeLatency() {
+  if (m_latencyPath.isEmpty()) {
+    return;
+  }
+  QFile file(m_latencyPath);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    QTextStream(stderr) << "Can't write latency file: " << m_latencyPath
+                        << Qt::endl;
+    return;
+  }
+  file.write(m_engine->getLatency()->toCsv().toUtf8());
+}
+
+void HeadlessRunner::writeTimeline() {
+  if (m_timelinePath.isEmpty()) {
+    return;
+  }
+  QFile file(m_timelinePath);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    QTextStream(stderr) << "Can't write timeline file: " << m_timelinePath
+                        << Qt::endl;
+    return;
+  }
+  file.write(m_engine->getTimeline()->toTraceEvents());
+}
+
+}  // namespace mms
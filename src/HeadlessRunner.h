@@ -0,0 +1,112 @@
+#pragma once
+
+#include <QMap>
+#include <QObject>
+#include <QProcess>
+#include <QQueue>
+#include <QSocketNotifier>
+#include <QString>
+#include <QStringList>
+
+#include "LineSplitter.h"
+#include "Maze.h"
+#include "RunTrace.h"
+#include "SimulationEngine.h"
+#include "TracePlayer.h"
+
+namespace mms {
+
+// Runs a single mouse algorithm on a single maze without a window, and prints
+// the final stats to stdout once the algorithm exits.
+//
+// In server mode, the algorithm is started once and kept alive for many runs,
+// which saves its startup time on every maze. Maze paths are read from stdin,
+// one per line, as they arrive, so the algorithm is still looked after while
+// the next path is on its way. Each run starts with a "newRun <width>
+// <height>" line to the algorithm, and ends once the algorithm sends
+// "endRun", which is answered with "endRun" after the run's stats are
+// printed. The stats of each run end with a blank line. Once stdin is closed,
+// so is the algorithm's stdin.
+class HeadlessRunner : public QObject {
+  Q_OBJECT
+
+ public:
+  HeadlessRunner(QObject *parent = nullptr);
+  ~HeadlessRunner();
+
+  // Returns false (after printing the reason) if the run couldn't be started.
+  // With sharedMemory, the algorithm is offered a SharedMemoryTransport.
+  bool start(const QString &mazePath, const QString &runCommand,
+             const QString &directory, bool sharedMemory);
+
+  // Starts the algorithm in server mode, returns false (after printing the
+  // reason) if it couldn't be started
+  bool startServer(const QString &runCommand, const QString &directory);
+
+  // Records the run started by start to a trace file, see RunTrace
+  void setTracePath(const QString &tracePath);
+
+  // Writes the latency histograms of the run or replay (see CommandLatency)
+  // as CSV
+  void setLatencyPath(const QString &latencyPath);
+
+  // Writes the timeline of the run or replay (see RunTimeline) as trace
+  // events
+  void setTimelinePath(const QString &timelinePath);
+
+  // Replays a trace instead of running an algorithm, and prints the stats
+  // that the run ended with; returns false if the trace is invalid
+  bool startReplay(const QString &tracePath);
+
+  // The arguments for running a headless worker process of this executable
+  static QStringList workerArguments(const QString &mazePath,
+                                     const QString &runCommand,
+                                     const QString &directory,
+                                     bool sharedMemory);
+
+  // The arguments for running a server mode worker process of this executable
+  static QStringList serverArguments(const QString &runCommand,
+                                     const QString &directory);
+
+  // Parses the "key value" lines printed once a run finishes
+  static QMap<QString, QString> parseSummary(const QString &output);
+
+ signals:
+  // Emitted once the algorithm exits; exitCode is zero on success
+  void finished(int exitCode);
+
+ private:
+  Maze *m_maze;
+  QString m_mazePath;
+  SimulationEngine *m_engine;
+  QProcess *m_process;
+
+  // Server mode
+  bool m_isServer;
+  QSocketNotifier *m_mazePathsNotifier;
+  LineSplitter m_mazePathSplitter;
+  QQueue<QString> m_mazePaths;
+  bool m_isEndOfMazePaths;
+  void onMazePathsReadable();
+  void addMazePath(QByteArrayView line);
+
+  // Recording and replay
+  QString m_tracePath;
+  TraceWriter *m_traceWriter;
+  TracePlayer *m_tracePlayer;
+
+  QString m_latencyPath;
+  void writeLatency();
+
+  QString m_timelinePath;
+  void writeTimeline();
+
+  bool loadMaze(const QString &mazePath);
+  void startNextRun();
+  void onRunEnded();
+  void onRunExit(int exitCode, QProcess::ExitStatus exitStatus);
+  void onReplayFinished();
+  void printSummary(bool complete);
+};
+
+}  // namespace mms
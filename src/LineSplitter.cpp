@@ -0,0 +1,57 @@
+#include "LineSplitter.h"
+
+#include <cstring>
+
+namespace mms {
+
+LineSplitter::LineSplitter()
+    : m_pending(QByteArray()),
+      m_joined(QByteArray()),
+      m_lines(QVector<QByteArrayView>()) {}
+
+const QVector<QByteArrayView> &LineSplitter::split(QByteArrayView chunk) {
+  m_lines.clear();
+  if (chunk.isEmpty()) {
+    return m_lines;
+  }
+  const char *begin = chunk.data();
+  const char *end = begin + chunk.size();
+  const char *newline = static_cast<const char *>(
+      std::memchr(begin, '\n', static_cast<size_t>(chunk.size())));
+
+  // Complete the pending line first, which is the only copy of a whole line
+  if (!m_pending.isEmpty() && newline != nullptr) {
+    m_joined.swap(m_pending);
+    m_pending.truncate(0);  // Keeps the allocation, unlike clear
+    m_joined.append(begin, newline - begin);
+    addLine(m_joined.constData(), m_joined.constData() + m_joined.size());
+    begin = newline + 1;
+    newline = static_cast<const char *>(
+        std::memchr(begin, '\n', static_cast<size_t>(end - begin)));
+  }
+
+  // Every other complete line is a view into the chunk itself
+  while (newline != nullptr) {
+    addLine(begin, newline);
+    begin = newline + 1;
+    newline = static_cast<const char *>(
+        std::memchr(begin, '\n', static_cast<size_t>(end - begin)));
+  }
+  m_pending.append(begin, end - begin);
+  return m_lines;
+}
+
+void LineSplitter::clear() {
+  m_pending.truncate(0);
+  m_joined.truncate(0);
+  m_lines.clear();
+}
+
+void LineSplitter::addLine(const char *begin, const char *end) {
+  if (begin != end && *(end - 1) == '\r') {
+    end -= 1;
+  }
+  m_lines.append(QByteArrayView(begin, end - begin));
+}
+
+}  // namespace mms
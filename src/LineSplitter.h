@@ -0,0 +1,37 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QVector>
+
+namespace mms {
+
+// Splits a stream of bytes into lines as it arrives, without copying complete
+// lines: each line is a view into the chunk that completed it, or into an
+// internal buffer if it spans more than one chunk. A trailing '\r' is dropped
+// from each line, for Windows compatibility.
+class LineSplitter {
+ public:
+  LineSplitter();
+
+  // Returns the lines completed by the chunk, without their newlines. The
+  // views are only valid until the next call, and as long as the chunk is.
+  const QVector<QByteArrayView> &split(QByteArrayView chunk);
+
+  // Drops any partial line
+  void clear();
+
+ private:
+  // The start of a line that hasn't been completed yet
+  QByteArray m_pending;
+
+  // The most recent line that spanned more than one chunk
+  QByteArray m_joined;
+
+  // Reused between calls to avoid an allocation per chunk
+  QVector<QByteArrayView> m_lines;
+
+  void addLine(const char *begin, const char *end);
+};
+
+}  // namespace mms
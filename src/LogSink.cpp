@@ -0,0 +1,102 @@
+#include "LogSink.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QStandardPaths>
+
+namespace mms {
+
+const int LogSink::MAX_LINES = 10000;
+const int LogSink::FLUSH_INTERVAL_MS = 200;
+
+LogSink::LogSink(QPlainTextEdit *output, const QString &name, QObject *parent)
+    : QObject(parent),
+      m_output(output),
+      m_lock(spillDirectory().filePath(QString("%1.lock").arg(name))),
+      m_spill(),
+      m_previousSpillPath(),
+      m_pending(QStringList()),
+      m_flushTimer(new QTimer(this)) {
+  // Stale locks of crashed instances are taken over
+  QString base = name;
+  if (!m_lock.tryLock(0)) {
+    base = QString("%1-%2").arg(name).arg(QCoreApplication::applicationPid());
+  }
+  m_spill.setFileName(spillDirectory().filePath(base + ".log"));
+  m_previousSpillPath = spillDirectory().filePath(base + ".1.log");
+
+  // Older blocks are dropped as new ones are appended
+  m_output->setMaximumBlockCount(MAX_LINES);
+  m_output->setToolTip(QString("Full log: %1\nPrevious log: %2")
+                           .arg(getSpillPath())
+                           .arg(getPreviousSpillPath()));
+  m_flushTimer->setSingleShot(true);
+  connect(m_flushTimer, &QTimer::timeout, this, &LogSink::flush);
+}
+
+LogSink::~LogSink() {
+  // Left on disk, for looking at the last run after exit, unless the files
+  // are named after this process and would only pile up
+  m_spill.close();
+  if (!m_lock.isLocked()) {
+    m_spill.remove();
+    QFile::remove(m_previousSpillPath);
+  }
+}
+
+void LogSink::append(const QString &line) {
+  if (!m_spill.isOpen()) {
+    rotate();
+    m_spill.open(QIODevice::WriteOnly | QIODevice::Truncate);
+  }
+  m_spill.write(line.toUtf8());
+  m_spill.write("\n");
+
+  // Lines beyond the limit would be dropped by the widget anyway
+  m_pending.append(line);
+  if (m_pending.size() > MAX_LINES) {
+    m_pending.removeFirst();
+  }
+  if (!m_flushTimer->isActive()) {
+    m_flushTimer->start(FLUSH_INTERVAL_MS);
+  }
+}
+
+void LogSink::clear() {
+  m_flushTimer->stop();
+  m_pending.clear();
+  m_output->clear();
+  m_spill.close();
+}
+
+QString LogSink::getSpillPath() const { return m_spill.fileName(); }
+
+QString LogSink::getPreviousSpillPath() const { return m_previousSpillPath; }
+
+void LogSink::flush() {
+  if (m_pending.isEmpty()) {
+    return;
+  }
+  // One append, and so one layout, for the whole batch
+  m_output->appendPlainText(m_pending.join('\n'));
+  m_pending.clear();
+  m_spill.flush();
+}
+
+QDir LogSink::spillDirectory() {
+  QString path =
+      QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+  QDir directory(path.isEmpty() ? QDir::tempPath() : path);
+  directory.mkpath("logs");
+  return QDir(directory.filePath("logs"));
+}
+
+void LogSink::rotate() {
+  // Only logs that got a line are kept, so clearing twice doesn't lose one
+  if (m_spill.exists() && m_spill.size() > 0) {
+    QFile::remove(m_previousSpillPath);
+    QFile::rename(getSpillPath(), m_previousSpillPath);
+  }
+}
+
+}  // namespace mms
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QDir>
+#include <QFile>
+#include <QLockFile>
+#include <QObject>
+#include <QPlainTextEdit>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+namespace mms {
+
+// Feeds lines of output to a QPlainTextEdit without letting a chatty process
+// take over the GUI. The widget only keeps the most recent MAX_LINES lines,
+// and is updated at most once every FLUSH_INTERVAL_MS with all of the lines
+// since the last update. Every line is also written to a spill file, so the
+// full log is still available after the run (and after exit). The spill file
+// is rotated once, to keep the previous log, when a new log starts.
+//
+// Spill files live in the user's app data directory. Each pair is locked by
+// the instance that uses it, so a second instance running at the same time
+// gets a pair of its own, named after its process id, rather than truncating
+// and rotating the first one's logs. Since no later instance will ever reuse
+// that pid, its pair is removed when the sink is destroyed.
+class LogSink : public QObject {
+  Q_OBJECT
+
+ public:
+  // The name distinguishes the spill files of different sinks
+  LogSink(QPlainTextEdit *output, const QString &name, QObject *parent);
+  ~LogSink();
+
+  void append(const QString &line);
+
+  // Empties the widget; the spill file is rotated by the next append
+  void clear();
+
+  QString getSpillPath() const;
+  QString getPreviousSpillPath() const;
+
+ private:
+  static const int MAX_LINES;
+  static const int FLUSH_INTERVAL_MS;
+
+  QPlainTextEdit *m_output;
+  QLockFile m_lock;
+  QFile m_spill;
+  QString m_previousSpillPath;
+
+  // Lines that haven't been shown yet, at most MAX_LINES of them
+  QStringList m_pending;
+  QTimer *m_flushTimer;
+
+  void flush();
+  void rotate();
+
+  // Creates the directory if needed
+  static QDir spillDirectory();
+};
+
+}  // namespace mms
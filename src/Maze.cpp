@@ -34,32 +34,73 @@ Maze *Maze::fromFile(const QString &path) {
   return fromNumFile(lines);
 }
 
-int Maze::getWidth() const { return m_tiles.size(); }
+Maze *Maze::fromWalls(int width, int height, const QVector<int> &cells) {
+  if (width < 1 || height < 1 || cells.size() != width * height) {
+    return nullptr;
+  }
+  BasicMaze basicMaze(width, QVector<QMap<Direction, bool>>(height));
+  for (int i = 0; i < cells.size(); i += 1) {
+    QMap<Direction, bool> &walls = basicMaze[i % width][i / width];
+    walls[Direction::NORTH] = cells.at(i) & 1;
+    walls[Direction::EAST] = cells.at(i) & 2;
+    walls[Direction::SOUTH] = cells.at(i) & 4;
+    walls[Direction::WEST] = cells.at(i) & 8;
+  }
+  if (!isValid(basicMaze)) {
+    return nullptr;
+  }
+  return new Maze(basicMaze);
+}
+
+QVector<int> Maze::toWalls() const {
+  QVector<int> cells;
+  for (int y = 0; y < getHeight(); y += 1) {
+    for (int x = 0; x < getWidth(); x += 1) {
+      cells.append((isWall(x, y, Direction::NORTH) ? 1 : 0) |
+                   (isWall(x, y, Direction::EAST) ? 2 : 0) |
+                   (isWall(x, y, Direction::SOUTH) ? 4 : 0) |
+                   (isWall(x, y, Direction::WEST) ? 8 : 0));
+    }
+  }
+  return cells;
+}
 
-int Maze::getHeight() const { return m_tiles.at(0).size(); }
+int Maze::getWidth() const { return m_width; }
 
-const Tile *Maze::getTile(int x, int y) const {
+int Maze::getHeight() const { return m_height; }
+
+bool Maze::isInCenter(QPair<int, int> location) const {
+  return getCenterPositions(getWidth(), getHeight()).contains(location);
+}
+
+int Maze::getDistance(int x, int y) const {
   ASSERT_LE(0, x);
   ASSERT_LE(0, y);
   ASSERT_LT(x, getWidth());
   ASSERT_LT(y, getHeight());
-  return &m_tiles.at(x).at(y);
+  return m_distances.at(y * m_width + x);
 }
 
-bool Maze::isInCenter(QPair<int, int> location) const {
-  return getCenterPositions(getWidth(), getHeight()).contains(location);
-}
-
-Maze::Maze(BasicMaze basicMaze) {
+Maze::Maze(BasicMaze basicMaze)
+    : m_width(basicMaze.size()),
+      m_height(basicMaze.at(0).size()),
+      m_horizontalWalls(QBitArray(m_width * (m_height + 1))),
+      m_verticalWalls(QBitArray((m_width + 1) * m_height)),
+      m_distances(QVector<int>()) {
+  // The maze is consistent, so each cell can set its own edges
   QVector<QVector<int>> distances = getDistances(basicMaze);
-  for (int x = 0; x < basicMaze.size(); x += 1) {
-    QVector<Tile> column;
-    for (int y = 0; y < basicMaze.at(x).size(); y += 1) {
-      Tile tile(x, y, distances.at(x).at(y), basicMaze.at(x).at(y));
-      tile.initPolygons(basicMaze.size(), basicMaze.at(x).size());
-      column.append(tile);
+  for (int y = 0; y < m_height; y += 1) {
+    for (int x = 0; x < m_width; x += 1) {
+      const QMap<Direction, bool> &walls = basicMaze.at(x).at(y);
+      m_horizontalWalls.setBit((y + 1) * m_width + x,
+                               walls.value(Direction::NORTH));
+      m_verticalWalls.setBit(y * (m_width + 1) + x + 1,
+                             walls.value(Direction::EAST));
+      m_horizontalWalls.setBit(y * m_width + x, walls.value(Direction::SOUTH));
+      m_verticalWalls.setBit(y * (m_width + 1) + x,
+                             walls.value(Direction::WEST));
+      m_distances.append(distances.at(x).at(y));
     }
-    m_tiles.append(column);
   }
 }
 
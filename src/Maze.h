@@ -1,9 +1,12 @@
 #pragma once
 
+#include <QBitArray>
+#include <QMap>
+#include <QPair>
 #include <QString>
 #include <QVector>
 
-#include "Tile.h"
+#include "Direction.h"
 
 namespace mms {
 
@@ -13,13 +16,30 @@ class Maze {
  public:
   static Maze *fromFile(const QString &path);
 
+  // One value per cell, row-major from the bottom left, which is the sum of 1
+  // for north, 2 for east, 4 for south, and 8 for west (as in setWalls)
+  static Maze *fromWalls(int width, int height, const QVector<int> &cells);
+  QVector<int> toWalls() const;
+
   int getWidth() const;
   int getHeight() const;
-  const Tile *getTile(int x, int y) const;
   bool isInCenter(QPair<int, int> location) const;
 
+  // Unchecked, the cell must be within the maze
+  bool isWall(int x, int y, Direction direction) const;
+
+  // The number of cells to the center, or -1 if it can't be reached
+  int getDistance(int x, int y) const;
+
  private:
-  QVector<QVector<Tile>> m_tiles;
+  // One bit per edge, shared by the cells on either side of it: horizontal
+  // edges are stored by row, with the south edge of the maze first, and
+  // vertical edges by row too, with width + 1 of them per row
+  int m_width;
+  int m_height;
+  QBitArray m_horizontalWalls;
+  QBitArray m_verticalWalls;
+  QVector<int> m_distances;
   explicit Maze(BasicMaze basicMaze);
 
   // Maze file formats
@@ -38,4 +58,18 @@ class Maze {
   static QVector<QPair<int, int>> getCenterPositions(int width, int height);
 };
 
+inline bool Maze::isWall(int x, int y, Direction direction) const {
+  switch (direction) {
+    case Direction::NORTH:
+      return m_horizontalWalls.testBit((y + 1) * m_width + x);
+    case Direction::EAST:
+      return m_verticalWalls.testBit(y * (m_width + 1) + x + 1);
+    case Direction::SOUTH:
+      return m_horizontalWalls.testBit(y * m_width + x);
+    case Direction::WEST:
+      return m_verticalWalls.testBit(y * (m_width + 1) + x);
+  }
+  return false;
+}
+
 }  // namespace mms
@@ -9,34 +9,113 @@ MazeGraphic::MazeGraphic(const Maze *maze, BufferInterface *bufferInterface,
   for (int x = 0; x < maze->getWidth(); x += 1) {
     QVector<TileGraphic> column;
     for (int y = 0; y < maze->getHeight(); y += 1) {
-      column.append(
-          TileGraphic(maze->getTile(x, y), bufferInterface, isTruthView));
+      column.append(TileGraphic(maze, x, y, bufferInterface, isTruthView));
     }
     m_tileGraphics.append(column);
+    m_pendingTiles.append(QVector<PendingTile>(maze->getHeight()));
   }
 }
 
 void MazeGraphic::setWall(int x, int y, Direction direction) {
-  m_tileGraphics[x][y].setWall(direction);
+  PendingTile &tile = pendingTile(x, y);
+  tile.setWalls |= wallBit(direction);
+  tile.clearedWalls &= ~wallBit(direction);
 }
 
 void MazeGraphic::clearWall(int x, int y, Direction direction) {
-  m_tileGraphics[x][y].clearWall(direction);
+  PendingTile &tile = pendingTile(x, y);
+  tile.clearedWalls |= wallBit(direction);
+  tile.setWalls &= ~wallBit(direction);
 }
 
 void MazeGraphic::setColor(int x, int y, Color color) {
-  m_tileGraphics[x][y].setColor(color);
+  PendingTile &tile = pendingTile(x, y);
+  tile.hasColor = true;
+  tile.isColorSet = true;
+  tile.color = color;
 }
 
 void MazeGraphic::clearColor(int x, int y) {
-  m_tileGraphics[x][y].clearColor();
+  PendingTile &tile = pendingTile(x, y);
+  tile.hasColor = true;
+  tile.isColorSet = false;
 }
 
 void MazeGraphic::setText(int x, int y, const QString &text) {
-  m_tileGraphics[x][y].setText(text);
+  PendingTile &tile = pendingTile(x, y);
+  tile.hasText = true;
+  tile.text = text;
 }
 
-void MazeGraphic::clearText(int x, int y) { m_tileGraphics[x][y].clearText(); }
+void MazeGraphic::clearText(int x, int y) { setText(x, y, QString()); }
+
+void MazeGraphic::applyPendingChanges() {
+  for (const QPair<int, int> &position : m_dirtyTiles) {
+    PendingTile &pending = m_pendingTiles[position.first][position.second];
+    TileGraphic &tile = m_tileGraphics[position.first][position.second];
+    for (Direction direction : CARDINAL_DIRECTIONS()) {
+      if (pending.setWalls & wallBit(direction)) {
+        tile.setWall(direction);
+      } else if (pending.clearedWalls & wallBit(direction)) {
+        tile.clearWall(direction);
+      }
+    }
+    if (pending.hasColor) {
+      if (pending.isColorSet) {
+        tile.setColor(pending.color);
+      } else {
+        tile.clearColor();
+      }
+    }
+    if (pending.hasText) {
+      tile.setText(pending.text);
+    }
+    pending = PendingTile();
+  }
+  m_dirtyTiles.clear();
+}
+
+QVector<MazeGraphic::TileState> MazeGraphic::getTileStates() const {
+  QVector<TileState> states;
+  for (int x = 0; x < m_tileGraphics.size(); x += 1) {
+    for (int y = 0; y < m_tileGraphics.at(x).size(); y += 1) {
+      states.append(tileState(x, y));
+    }
+  }
+  return states;
+}
+
+void MazeGraphic::setTileStates(const QVector<TileState> &states) {
+  int i = 0;
+  for (int x = 0; x < m_tileGraphics.size(); x += 1) {
+    for (int y = 0; y < m_tileGraphics.at(x).size(); y += 1) {
+      const TileState &target = states.at(i);
+      i += 1;
+      TileState current = tileState(x, y);
+      for (Direction direction : CARDINAL_DIRECTIONS()) {
+        int bit = wallBit(direction);
+        if ((target.walls & bit) == (current.walls & bit)) {
+          continue;
+        }
+        if (target.walls & bit) {
+          setWall(x, y, direction);
+        } else {
+          clearWall(x, y, direction);
+        }
+      }
+      if (!target.isColorSet) {
+        if (current.isColorSet) {
+          clearColor(x, y);
+        }
+      } else if (!current.isColorSet || current.color != target.color) {
+        setColor(x, y, target.color);
+      }
+      if (target.text != current.text) {
+        setText(x, y, target.text);
+      }
+    }
+  }
+}
 
 void MazeGraphic::drawPolygons() const {
   // Fill the GRAPHIC_CPU_BUFFER
@@ -56,6 +135,37 @@ void MazeGraphic::drawTextures() const {
   }
 }
 
+MazeGraphic::PendingTile &MazeGraphic::pendingTile(int x, int y) {
+  PendingTile &tile = m_pendingTiles[x][y];
+  if (!tile.isDirty) {
+    tile.isDirty = true;
+    m_dirtyTiles.append(QPair<int, int>(x, y));
+  }
+  return tile;
+}
+
+MazeGraphic::TileState MazeGraphic::tileState(int x, int y) const {
+  const TileGraphic &tile = m_tileGraphics.at(x).at(y);
+  const PendingTile &pending = m_pendingTiles.at(x).at(y);
+  TileState state;
+  for (Direction direction : CARDINAL_DIRECTIONS()) {
+    if (tile.isWall(direction)) {
+      state.walls |= wallBit(direction);
+    }
+  }
+  state.walls = (state.walls | pending.setWalls) & ~pending.clearedWalls;
+  state.isColorSet = pending.hasColor ? pending.isColorSet : tile.isColorSet();
+  if (state.isColorSet) {
+    state.color = pending.hasColor ? pending.color : tile.getColor();
+  }
+  state.text = pending.hasText ? pending.text : tile.getText();
+  return state;
+}
+
+int MazeGraphic::wallBit(Direction direction) {
+  return 1 << static_cast<int>(direction);
+}
+
 void MazeGraphic::refreshColors() {
   for (int x = 0; x < m_tileGraphics.size(); x += 1) {
     for (int y = 0; y < m_tileGraphics.at(x).size(); y += 1) {
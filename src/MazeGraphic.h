@@ -1,5 +1,7 @@
 #pragma once
 
+#include <QPair>
+#include <QString>
 #include <QVector>
 
 #include "BufferInterface.h"
@@ -9,8 +11,20 @@
 
 namespace mms {
 
+// Changes to walls, colors, and text are only recorded when they're made, and
+// take effect once applyPendingChanges is called, which happens once per
+// frame. Only the last change to each wall, color, or text of a cell is kept,
+// so a cell that's repainted many times within a frame is only redrawn once.
 class MazeGraphic {
  public:
+  // The walls, color, and text of a single cell, including pending changes
+  struct TileState {
+    int walls = 0;  // Bitmask of Direction values
+    bool isColorSet = false;
+    Color color = Color::BLACK;
+    QString text;
+  };
+
   MazeGraphic(const Maze *maze, BufferInterface *bufferInterface,
               bool isTruthView);
 
@@ -23,13 +37,40 @@ class MazeGraphic {
   void setText(int x, int y, const QString &text);
   void clearText(int x, int y);
 
+  void applyPendingChanges();
+
+  // The state of every cell, column by column; restoring it only records
+  // changes for the cells that differ
+  QVector<TileState> getTileStates() const;
+  void setTileStates(const QVector<TileState> &states);
+
   void drawPolygons() const;
   void drawTextures() const;
 
   void refreshColors();
 
  private:
+  // The changes to a single cell since the last applyPendingChanges
+  struct PendingTile {
+    bool isDirty = false;
+    int setWalls = 0;  // Bitmasks of Direction values
+    int clearedWalls = 0;
+    bool hasColor = false;
+    bool isColorSet = false;
+    Color color = Color::BLACK;
+    bool hasText = false;
+    QString text;  // Empty to clear the text
+  };
+
   QVector<QVector<TileGraphic>> m_tileGraphics;
+  QVector<QVector<PendingTile>> m_pendingTiles;
+
+  // The cells with pending changes, so applying them doesn't visit every cell
+  QVector<QPair<int, int>> m_dirtyTiles;
+
+  PendingTile &pendingTile(int x, int y);
+  TileState tileState(int x, int y) const;
+  static int wallBit(Direction direction);
 };
 
 }  // namespace mms
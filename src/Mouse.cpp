@@ -75,6 +75,12 @@ void Mouse::teleport(const Coordinate &translation, const Angle &rotation) {
   m_currentRotation = rotation;
 }
 
+Coordinate Mouse::getCurrentTranslation() const {
+  return m_currentTranslation;
+}
+
+Angle Mouse::getCurrentRotation() const { return m_currentRotation; }
+
 SemiPosition Mouse::getCurrentDiscretizedTranslation() const {
   static Distance halfTileLength = Dimensions::halfTileLength();
   static Distance quarterTileLength = Dimensions::quarterTileLength();
@@ -48,6 +48,10 @@ class Mouse {
   // Sets the current translation and rotation of the mouse
   void teleport(const Coordinate &translation, const Angle &rotation);
 
+  // Gets the current translation and rotation of the mouse
+  Coordinate getCurrentTranslation() const;
+  Angle getCurrentRotation() const;
+
   // Gets the current discretized translation and rotation of the mouse
   SemiPosition getCurrentDiscretizedTranslation() const;
   SemiDirection getCurrentDiscretizedRotation() const;
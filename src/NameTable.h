@@ -0,0 +1,95 @@
+#pragma once
+
+#include <QByteArrayView>
+#include <cstdint>
+#include <cstring>
+
+namespace mms {
+
+template <typename T>
+struct NameEntry {
+  const char *name;
+  T value;
+};
+
+// A compile-time map from names to values, built as a perfect hash: the seed
+// is searched for at compile time such that every name hashes to a slot of its
+// own. A lookup is then one hash and at most one comparison, even for names
+// that aren't in the table, and never allocates.
+template <typename T, int NUM_ENTRIES>
+class NameTable {
+ public:
+  constexpr NameTable(const NameEntry<T> (&entries)[NUM_ENTRIES])
+      : m_entries(), m_slots(), m_seed(0), m_isPerfect(false) {
+    for (int i = 0; i < NUM_ENTRIES; i += 1) {
+      m_entries[i] = entries[i];
+    }
+    while (!m_isPerfect && m_seed < MAX_SEED) {
+      m_isPerfect = tryBuild();
+      m_seed += m_isPerfect ? 0 : 1;
+    }
+  }
+
+  // Should be checked with a static_assert, lookups fail otherwise
+  constexpr bool isPerfect() const { return m_isPerfect; }
+
+  // Returns whether the name was found, and its value if so
+  bool lookup(QByteArrayView name, T *value) const {
+    int index = m_slots[slot(name.data(), name.size())];
+    if (index < 0) {
+      return false;
+    }
+    const char *candidate = m_entries[index].name;
+    if (length(candidate) != name.size() ||
+        std::memcmp(candidate, name.data(), name.size()) != 0) {
+      return false;
+    }
+    *value = m_entries[index].value;
+    return true;
+  }
+
+ private:
+  // Sparse enough that a seed is found within a few tries
+  static constexpr int NUM_SLOTS = 8 * NUM_ENTRIES;
+  static constexpr uint32_t MAX_SEED = 1000;
+
+  NameEntry<T> m_entries[NUM_ENTRIES];
+  int16_t m_slots[NUM_SLOTS];
+  uint32_t m_seed;
+  bool m_isPerfect;
+
+  static constexpr int length(const char *name) {
+    int size = 0;
+    while (name[size] != '\0') {
+      size += 1;
+    }
+    return size;
+  }
+
+  // FNV-1a, with the seed mixed into the offset basis
+  constexpr int slot(const char *name, qsizetype size) const {
+    uint32_t hash = 2166136261u ^ m_seed;
+    for (qsizetype i = 0; i < size; i += 1) {
+      hash ^= static_cast<unsigned char>(name[i]);
+      hash *= 16777619u;
+    }
+    return static_cast<int>((hash ^ (hash >> 16)) % NUM_SLOTS);
+  }
+
+  constexpr bool tryBuild() {
+    for (int i = 0; i < NUM_SLOTS; i += 1) {
+      m_slots[i] = -1;
+    }
+    for (int i = 0; i < NUM_ENTRIES; i += 1) {
+      const char *name = m_entries[i].name;
+      int16_t &index = m_slots[slot(name, length(name))];
+      if (index != -1) {
+        return false;
+      }
+      index = static_cast<int16_t>(i);
+    }
+    return true;
+  }
+};
+
+}  // namespace mms
@@ -0,0 +1,197 @@
+#include "RunTimeline.h"
+
+#include <algorithm>
+
+#include "TextProtocol.h"
+
+namespace mms {
+
+const int RunTimeline::MAX_EVENTS = 1000000;
+
+RunTimeline::RunTimeline()
+    : m_events(QVector<TimelineEvent>()),
+      m_spans(QVector<TimelineEvent>()),
+      m_spanIds(QVector<qint64>()),
+      m_numSpans(0),
+      m_openSpans(QVector<qint64>()),
+      m_endMicros(0),
+      m_numDroppedEvents(0) {}
+
+void RunTimeline::clear() {
+  m_events.clear();
+  m_spans.clear();
+  m_spanIds.clear();
+  m_numSpans = 0;
+  m_openSpans.clear();
+  m_endMicros = 0;
+  m_numDroppedEvents = 0;
+}
+
+RunTimeline::State RunTimeline::getState() const {
+  return {m_numDroppedEvents + m_events.size(), m_numSpans, m_openSpans,
+          m_endMicros};
+}
+
+void RunTimeline::rewind(const State &state) {
+  qint64 numEvents = state.numEvents - m_numDroppedEvents;
+  if (numEvents < 0) {
+    m_events.clear();
+    m_numDroppedEvents = state.numEvents;
+  } else if (numEvents < m_events.size()) {
+    m_events.resize(numEvents);
+  }
+  int numSpans =
+      std::lower_bound(m_spanIds.begin(), m_spanIds.end(), state.numSpans) -
+      m_spanIds.begin();
+  m_spans.resize(numSpans);
+  m_spanIds.resize(numSpans);
+  m_numSpans = state.numSpans;
+  m_openSpans.clear();
+  for (qint64 id : state.openSpans) {
+    int index = spanIndex(id);
+    if (index != -1) {
+      m_spans[index].endMicros = -1;
+      m_openSpans.append(id);
+    }
+  }
+  m_endMicros = state.endMicros;
+}
+
+void RunTimeline::addMovement(CommandType type, qint64 beginMicros,
+                              qint64 endMicros) {
+  append({TimelineKind::MOVEMENT,
+          QString::fromLatin1(TextProtocol::commandName(type)), beginMicros,
+          endMicros, 0});
+}
+
+void RunTimeline::addMark(const QString &label, qint64 micros) {
+  append({TimelineKind::MARK, label, micros, micros, m_openSpans.size()});
+}
+
+void RunTimeline::beginSpan(const QString &label, qint64 micros) {
+  if (m_spans.size() >= MAX_EVENTS) {
+    dropSpans();
+  }
+  m_openSpans.append(m_numSpans);
+  m_spans.append(
+      {TimelineKind::SPAN, label, micros, -1, m_openSpans.size() - 1});
+  m_spanIds.append(m_numSpans);
+  m_numSpans += 1;
+  m_endMicros = qMax(m_endMicros, micros);
+}
+
+void RunTimeline::endSpan(const QString &label, qint64 micros) {
+  for (int i = m_openSpans.size() - 1; i >= 0; i -= 1) {
+    TimelineEvent &span = m_spans[spanIndex(m_openSpans.at(i))];
+    if (span.label == label) {
+      span.endMicros = micros;
+      m_openSpans.remove(i);
+      m_endMicros = qMax(m_endMicros, micros);
+      return;
+    }
+  }
+}
+
+const QVector<TimelineEvent> &RunTimeline::getEvents() const {
+  return m_events;
+}
+
+const QVector<TimelineEvent> &RunTimeline::getSpans() const { return m_spans; }
+
+qint64 RunTimeline::getEndMicros() const { return m_endMicros; }
+
+QByteArray RunTimeline::toTraceEvents() const {
+  auto quoted = [](const QString &text) {
+    QByteArray escaped = "\"";
+    for (char c : text.toUtf8()) {
+      if (c == '"' || c == '\\') {
+        escaped.append('\\');
+        escaped.append(c);
+      } else if (static_cast<unsigned char>(c) < 0x20) {
+        escaped.append(' ');  // Only tabs can get past the protocols
+      } else {
+        escaped.append(c);
+      }
+    }
+    escaped.append('"');
+    return escaped;
+  };
+
+  // The simulator's movements and the algorithm's markers on separate tracks
+  QByteArray json = "{\"traceEvents\":[\n";
+  bool isFirst = true;
+  auto appendEvent = [&](const TimelineEvent &event, int track) {
+    json.append(isFirst ? "" : ",\n");
+    isFirst = false;
+    json.append("{\"name\":");
+    json.append(quoted(event.label));
+    json.append(",\"pid\":1,\"tid\":");
+    json.append(QByteArray::number(track));
+    json.append(",\"ts\":");
+    json.append(QByteArray::number(event.beginMicros));
+    if (event.kind == TimelineKind::MARK) {
+      json.append(",\"ph\":\"i\",\"s\":\"t\"}");
+    } else {
+      qint64 endMicros = event.endMicros < 0 ? m_endMicros : event.endMicros;
+      json.append(",\"ph\":\"X\",\"dur\":");
+      json.append(QByteArray::number(endMicros - event.beginMicros));
+      json.append("}");
+    }
+  };
+  for (const TimelineEvent &event : m_events) {
+    appendEvent(event, event.kind == TimelineKind::MOVEMENT ? 1 : 2);
+  }
+  for (const TimelineEvent &span : m_spans) {
+    appendEvent(span, 2);
+  }
+  json.append("\n]}\n");
+  return json;
+}
+
+void RunTimeline::append(const TimelineEvent &event) {
+  // Dropped in batches, so that each event is only moved a few times
+  if (m_events.size() >= MAX_EVENTS) {
+    m_events.remove(0, MAX_EVENTS / 10);
+    m_numDroppedEvents += MAX_EVENTS / 10;
+  }
+  m_events.append(event);
+  m_endMicros = qMax(m_endMicros, event.endMicros);
+}
+
+int RunTimeline::spanIndex(qint64 id) const {
+  auto it = std::lower_bound(m_spanIds.begin(), m_spanIds.end(), id);
+  return it != m_spanIds.end() && *it == id
+             ? static_cast<int>(it - m_spanIds.begin())
+             : -1;
+}
+
+void RunTimeline::dropSpans() {
+  // Like events, in batches. Closed spans go first, oldest first, since open
+  // ones can still be ended; if there aren't enough of them (the algorithm
+  // never ends its spans), the oldest open spans go too, and are forgotten.
+  int numToDrop = MAX_EVENTS / 10;
+  for (bool isDroppingOpen : {false, true}) {
+    int numKept = 0;
+    for (int i = 0; i < m_spans.size(); i += 1) {
+      bool isOpen = m_spans.at(i).endMicros < 0;
+      if (numToDrop > 0 && isOpen == isDroppingOpen) {
+        numToDrop -= 1;
+        continue;
+      }
+      m_spans[numKept] = m_spans.at(i);
+      m_spanIds[numKept] = m_spanIds.at(i);
+      numKept += 1;
+    }
+    m_spans.resize(numKept);
+    m_spanIds.resize(numKept);
+  }
+  QVector<qint64> openSpans;
+  for (qint64 id : m_openSpans) {
+    if (spanIndex(id) != -1) {
+      openSpans.append(id);
+    }
+  }
+  m_openSpans = openSpans;
+}
+
+}  // namespace mms
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+#include "Command.h"
+
+namespace mms {
+
+enum class TimelineKind {
+  MOVEMENT,  // From a movement command arriving to its response
+  MARK,      // A single point in time, see CommandType::MARK
+  SPAN,      // From a span begin to the matching span end
+};
+
+struct TimelineEvent {
+  TimelineKind kind;
+  QString label;
+  qint64 beginMicros;
+  qint64 endMicros;  // Equal to beginMicros for marks, -1 for open spans
+  int depth;         // The number of spans that were open at the beginning
+};
+
+// What happened when during a run, in wall-clock microseconds since the run
+// started: the movements that the simulator carried out, and the markers that
+// the algorithm sent to show what it was doing in the meantime. Only the most
+// recent MAX_EVENTS movements and marks are kept, and at most MAX_EVENTS
+// spans, the oldest closed ones being dropped first, then the oldest open
+// ones.
+class RunTimeline {
+ public:
+  static const int MAX_EVENTS;
+
+  // How far the timeline had gotten at some point, see rewind
+  struct State {
+    qint64 numEvents;  // Including the ones that were dropped
+    qint64 numSpans;   // Likewise
+    QVector<qint64> openSpans;
+    qint64 endMicros;
+  };
+
+  RunTimeline();
+  void clear();
+
+  // Drops everything added after the state was saved, and reopens the spans
+  // that were open then; events dropped since then can't be brought back
+  State getState() const;
+  void rewind(const State &state);
+
+  void addMovement(CommandType type, qint64 beginMicros, qint64 endMicros);
+  void addMark(const QString &label, qint64 micros);
+
+  // An end closes the innermost open span with the same label, if any
+  void beginSpan(const QString &label, qint64 micros);
+  void endSpan(const QString &label, qint64 micros);
+
+  // Movements and marks, ordered by when they end
+  const QVector<TimelineEvent> &getEvents() const;
+
+  // Spans, ordered by when they begin
+  const QVector<TimelineEvent> &getSpans() const;
+
+  // The latest time of any event
+  qint64 getEndMicros() const;
+
+  // The Trace Event Format understood by chrome://tracing and Perfetto
+  QByteArray toTraceEvents() const;
+
+ private:
+  QVector<TimelineEvent> m_events;
+  QVector<TimelineEvent> m_spans;
+
+  // The number of spans begun before each one in m_spans (which, unlike its
+  // index, doesn't change as older spans are dropped), and of all spans
+  QVector<qint64> m_spanIds;
+  qint64 m_numSpans;
+
+  QVector<qint64> m_openSpans;  // Ids of spans, innermost last
+  qint64 m_endMicros;
+  qint64 m_numDroppedEvents;
+
+  void append(const TimelineEvent &event);
+
+  // The index into m_spans of the span with the id, or -1 if it was dropped
+  int spanIndex(qint64 id) const;
+  void dropSpans();
+};
+
+}  // namespace mms
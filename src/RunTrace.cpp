@@ -0,0 +1,162 @@
+#include "RunTrace.h"
+
+#include <cstring>
+#include <limits>
+
+namespace mms {
+
+const char RunTrace::MAGIC[4] = {'M', 'M', 'S', 'T'};
+const char RunTrace::VERSION = 1;
+
+bool RunTrace::read(const QString &path, RunTrace *trace) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+  QByteArray bytes = file.readAll();
+  if (bytes.size() < 5 || std::memcmp(bytes.constData(), MAGIC, 4) != 0 ||
+      bytes.at(4) != VERSION) {
+    return false;
+  }
+
+  // The maze
+  int offset = 5;
+  // Each dimension is checked on its own first, so that the product can't
+  // wrap around, and the number of cells has to fit in an int too
+  const quint64 maxCells = std::numeric_limits<int>::max();
+  quint64 width = 0;
+  quint64 height = 0;
+  if (!readVarint(bytes, &offset, &width) ||
+      !readVarint(bytes, &offset, &height) || width == 0 || height == 0 ||
+      width > maxCells || height > maxCells || width * height > maxCells ||
+      width * height > static_cast<quint64>(bytes.size() - offset) * 2) {
+    return false;
+  }
+  trace->mazeWidth = static_cast<int>(width);
+  trace->mazeHeight = static_cast<int>(height);
+  trace->mazeWalls.clear();
+  for (int i = 0; i < trace->mazeWidth * trace->mazeHeight; i += 1) {
+    uchar pair = static_cast<uchar>(bytes.at(offset + i / 2));
+    trace->mazeWalls.append(i % 2 == 0 ? pair & 0x0F : pair >> 4);
+  }
+  offset += (trace->mazeWidth * trace->mazeHeight + 1) / 2;
+  quint64 pathSize = 0;
+  if (!readVarint(bytes, &offset, &pathSize) ||
+      pathSize > static_cast<quint64>(bytes.size() - offset)) {
+    return false;
+  }
+  trace->mazePath = QString::fromUtf8(bytes.constData() + offset,
+                                      static_cast<int>(pathSize));
+  offset += static_cast<int>(pathSize);
+
+  // The records, up to the end or a truncated one (e.g., from a crash)
+  trace->records.clear();
+  qint64 micros = 0;
+  while (offset < bytes.size()) {
+    TraceRecord record;
+    record.kind = static_cast<TraceKind>(bytes.at(offset));
+    offset += 1;
+    quint64 delta = 0;
+    quint64 size = 0;
+    if (record.kind > TraceKind::RESET ||
+        !readVarint(bytes, &offset, &delta) ||
+        !readVarint(bytes, &offset, &size) ||
+        size > static_cast<quint64>(bytes.size() - offset)) {
+      break;
+    }
+    // A delta that no recording could have written would leave the times
+    // out of order, which replays rely on
+    if (delta >
+        static_cast<quint64>(std::numeric_limits<qint64>::max() - micros)) {
+      return false;
+    }
+    micros += static_cast<qint64>(delta);
+    record.micros = micros;
+    record.bytes = bytes.mid(offset, static_cast<int>(size));
+    offset += static_cast<int>(size);
+    trace->records.append(record);
+  }
+  return true;
+}
+
+Maze *RunTrace::createMaze() const {
+  return Maze::fromWalls(mazeWidth, mazeHeight, mazeWalls);
+}
+
+void RunTrace::appendVarint(QByteArray *bytes, quint64 value) {
+  while (value >= 0x80) {
+    bytes->append(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  bytes->append(static_cast<char>(value));
+}
+
+bool RunTrace::readVarint(const QByteArray &bytes, int *offset,
+                          quint64 *value) {
+  *value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (*offset >= bytes.size()) {
+      return false;
+    }
+    uchar byte = static_cast<uchar>(bytes.at(*offset));
+    *offset += 1;
+    *value |= static_cast<quint64>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+TraceWriter::TraceWriter()
+    : m_file(), m_timer(), m_lastMicros(0), m_record(QByteArray()) {}
+
+TraceWriter::~TraceWriter() { close(); }
+
+bool TraceWriter::open(const QString &path, const Maze *maze,
+                       const QString &mazePath) {
+  m_file.setFileName(path);
+  if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    return false;
+  }
+  QByteArray header(RunTrace::MAGIC, 4);
+  header.append(RunTrace::VERSION);
+  RunTrace::appendVarint(&header, maze->getWidth());
+  RunTrace::appendVarint(&header, maze->getHeight());
+  QVector<int> walls = maze->toWalls();
+  for (int i = 0; i < walls.size(); i += 2) {
+    int high = i + 1 < walls.size() ? walls.at(i + 1) : 0;
+    header.append(static_cast<char>(walls.at(i) | high << 4));
+  }
+  QByteArray pathBytes = mazePath.toUtf8();
+  RunTrace::appendVarint(&header, pathBytes.size());
+  header.append(pathBytes);
+  m_file.write(header);
+  m_lastMicros = 0;
+  m_timer.start();
+  return true;
+}
+
+void TraceWriter::record(TraceKind kind, QByteArrayView bytes) {
+  if (!m_file.isOpen()) {
+    return;
+  }
+  qint64 micros = m_timer.nsecsElapsed() / 1000;
+  m_record.truncate(0);
+  m_record.append(static_cast<char>(kind));
+  RunTrace::appendVarint(&m_record, micros - m_lastMicros);
+  RunTrace::appendVarint(&m_record, bytes.size());
+  m_record.append(bytes);
+  m_lastMicros = micros;
+
+  // Buffered by the file, so this is usually just a copy
+  m_file.write(m_record);
+}
+
+void TraceWriter::close() {
+  if (m_file.isOpen()) {
+    m_file.close();
+  }
+}
+
+}  // namespace mms
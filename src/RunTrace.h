@@ -0,0 +1,87 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+#include "Maze.h"
+
+namespace mms {
+
+// What happened at one point of a run
+enum class TraceKind : unsigned char {
+  COMMANDS = 0x00,   // Bytes received from the algorithm
+  RESPONSES = 0x01,  // Bytes sent to the algorithm
+  RESET = 0x02,      // The reset button was pressed, no bytes
+};
+
+struct TraceRecord {
+  TraceKind kind = TraceKind::COMMANDS;
+  qint64 micros = 0;  // Wall-clock time since the start of the run
+  QByteArray bytes;
+};
+
+// A recording of everything that passed between the simulator and an
+// algorithm during one run, together with the maze it ran on. The file starts
+// with the magic "MMST", a version byte, the maze's width, height, and walls
+// (two cells per byte, as in Maze::toWalls), and the maze's path. Each record
+// is then a kind byte, the time since the previous record in microseconds,
+// and the number of bytes followed by the bytes themselves. All numbers are
+// unsigned LEB128 varints, so most records only have three bytes of overhead.
+class RunTrace {
+ public:
+  QString mazePath;
+  int mazeWidth = 0;
+  int mazeHeight = 0;
+  QVector<int> mazeWalls;
+  QVector<TraceRecord> records;
+
+  // Returns false if the file can't be read or isn't a valid trace
+  static bool read(const QString &path, RunTrace *trace);
+
+  // Returns nullptr if the walls don't make a valid maze
+  Maze *createMaze() const;
+
+ private:
+  static const char MAGIC[4];
+  static const char VERSION;
+
+  static void appendVarint(QByteArray *bytes, quint64 value);
+  static bool readVarint(const QByteArray &bytes, int *offset,
+                         quint64 *value);
+
+  friend class TraceWriter;
+};
+
+// The times at which a run that's being replayed did things, so that the
+// replay's latency and timeline match the recorded run rather than the replay
+class RecordedClock {
+ public:
+  virtual ~RecordedClock() = default;
+
+  // When the last response byte written so far was sent in the recording
+  virtual qint64 getResponseMicros() const = 0;
+};
+
+// Appends records to a trace file as a run goes
+class TraceWriter {
+ public:
+  TraceWriter();
+  ~TraceWriter();
+
+  // Writes the header and starts the clock, returns false on failure
+  bool open(const QString &path, const Maze *maze, const QString &mazePath);
+  void record(TraceKind kind, QByteArrayView bytes);
+  void close();
+
+ private:
+  QFile m_file;
+  QElapsedTimer m_timer;
+  qint64 m_lastMicros;
+  QByteArray m_record;  // Reused between records
+};
+
+}  // namespace mms
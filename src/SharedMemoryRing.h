@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+// This header has no Qt dependency, so that algorithms can include it directly
+// to talk to the simulator through a SharedMemoryTransport
+
+namespace mms {
+
+// A single-producer, single-consumer byte queue that lives in shared memory.
+// The head and tail count every byte ever written and read (wrapping around at
+// 2^32), so the number of queued bytes is always head - tail.
+struct SharedMemoryRing {
+  static const uint32_t CAPACITY = 1 << 16;  // Must be a power of two
+
+  // Each on its own cache line, so the two sides don't contend
+  alignas(64) std::atomic<uint32_t> head;  // Only written by the producer
+  alignas(64) std::atomic<uint32_t> tail;  // Only written by the consumer
+  alignas(64) char data[CAPACITY];
+
+  // Copies in as many bytes as fit, returns the number copied
+  uint32_t write(const char *bytes, uint32_t size) {
+    uint32_t h = head.load(std::memory_order_relaxed);
+    uint32_t free = CAPACITY - (h - tail.load(std::memory_order_acquire));
+    uint32_t count = size < free ? size : free;
+    uint32_t offset = h & (CAPACITY - 1);
+    uint32_t first = count < CAPACITY - offset ? count : CAPACITY - offset;
+    std::memcpy(data + offset, bytes, first);
+    std::memcpy(data, bytes + first, count - first);
+    head.store(h + count, std::memory_order_release);
+    return count;
+  }
+
+  // Copies out as many bytes as are queued, up to size, returns the number
+  uint32_t read(char *bytes, uint32_t size) {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    uint32_t queued = head.load(std::memory_order_acquire) - t;
+    uint32_t count = size < queued ? size : queued;
+    uint32_t offset = t & (CAPACITY - 1);
+    uint32_t first = count < CAPACITY - offset ? count : CAPACITY - offset;
+    std::memcpy(bytes, data + offset, first);
+    std::memcpy(bytes + first, data, count - first);
+    tail.store(t + count, std::memory_order_release);
+    return count;
+  }
+
+  uint32_t numQueued() const {
+    return head.load(std::memory_order_acquire) -
+           tail.load(std::memory_order_acquire);
+  }
+};
+
+// The layout of the whole region. The algorithm produces commands and consumes
+// responses, in exactly the same format as on stdout and stdin.
+//
+// The simulator sleeps while the command ring stays empty, so after writing
+// commands, the algorithm must call shouldRingDoorbell, and if it returns
+// true, write a single byte to the FIFO at doorbellPath (opened once, with
+// O_WRONLY | O_NONBLOCK) to wake the simulator up.
+struct SharedMemoryRegion {
+  static const uint32_t MAGIC = 0x32736d6d;  // "mms2", set once initialized
+  static const uint32_t MAX_PATH_SIZE = 256;
+
+  uint32_t magic;
+  char doorbellPath[MAX_PATH_SIZE];  // Null-terminated
+
+  // Only set by the simulator, right before it goes to sleep
+  alignas(64) std::atomic<uint32_t> isSimulatorAsleep;
+
+  SharedMemoryRing commands;
+  SharedMemoryRing responses;
+
+  // The fence orders the commands before the check, and the simulator does
+  // the same the other way around, so at least one side sees the other
+  bool shouldRingDoorbell() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return isSimulatorAsleep.load(std::memory_order_relaxed) != 0 &&
+           isSimulatorAsleep.exchange(0) != 0;
+  }
+};
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2,
+              "Shared memory rings need lock-free atomics");
+
+}  // namespace mms
@@ -0,0 +1,192 @@
+#include "SharedMemoryTransport.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <cstring>
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mms {
+
+const char *SharedMemoryTransport::NAME_VARIABLE = "MMS_SHM";
+const qint64 SharedMemoryTransport::IDLE_NANOS_BEFORE_SLEEP = 50000;
+
+SharedMemoryTransport *SharedMemoryTransport::create(QObject *parent) {
+#ifdef Q_OS_UNIX
+  // Unique per run, even with many simulators running at once
+  static int numCreated = 0;
+  QString name = QString("/mms-%1-%2")
+                     .arg(QCoreApplication::applicationPid())
+                     .arg(numCreated);
+  numCreated += 1;
+
+  // The read end of the doorbell has to be open before the write end
+  QByteArray doorbellPath = (QDir::tempPath() + name + ".doorbell").toUtf8();
+  if (doorbellPath.size() >= SharedMemoryRegion::MAX_PATH_SIZE ||
+      mkfifo(doorbellPath.constData(), 0600) != 0) {
+    return nullptr;
+  }
+  int doorbellFd =
+      ::open(doorbellPath.constData(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+  int doorbellWriteFd =
+      doorbellFd == -1
+          ? -1
+          : ::open(doorbellPath.constData(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+  auto removeDoorbell = [&]() {
+    if (doorbellFd != -1) {
+      ::close(doorbellFd);
+    }
+    if (doorbellWriteFd != -1) {
+      ::close(doorbellWriteFd);
+    }
+    unlink(doorbellPath.constData());
+  };
+  if (doorbellWriteFd == -1) {
+    removeDoorbell();
+    return nullptr;
+  }
+
+  QByteArray path = name.toUtf8();
+  int fd = shm_open(path.constData(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd == -1) {
+    removeDoorbell();
+    return nullptr;
+  }
+  void *memory = MAP_FAILED;
+  if (ftruncate(fd, sizeof(SharedMemoryRegion)) == 0) {
+    memory = mmap(nullptr, sizeof(SharedMemoryRegion), PROT_READ | PROT_WRITE,
+                  MAP_SHARED, fd, 0);
+  }
+  ::close(fd);  // Not QIODevice::close
+  if (memory == MAP_FAILED) {
+    shm_unlink(path.constData());
+    removeDoorbell();
+    return nullptr;
+  }
+
+  // The region starts out zeroed, i.e., with both rings empty and the
+  // simulator awake
+  SharedMemoryRegion *region = static_cast<SharedMemoryRegion *>(memory);
+  std::memcpy(region->doorbellPath, doorbellPath.constData(),
+              doorbellPath.size());
+  region->magic = SharedMemoryRegion::MAGIC;
+  return new SharedMemoryTransport(name, region, doorbellFd, doorbellWriteFd,
+                                   parent);
+#else
+  Q_UNUSED(parent);
+  return nullptr;
+#endif
+}
+
+SharedMemoryTransport::SharedMemoryTransport(const QString &name,
+                                             SharedMemoryRegion *region,
+                                             int doorbellFd,
+                                             int doorbellWriteFd,
+                                             QObject *parent)
+    : QIODevice(parent),
+      m_name(name),
+      m_region(region),
+      m_doorbellFd(doorbellFd),
+      m_doorbellWriteFd(doorbellWriteFd),
+      m_doorbellNotifier(
+          new QSocketNotifier(doorbellFd, QSocketNotifier::Read, this)),
+      m_pendingResponses(QByteArray()),
+      m_pollTimer(new QTimer(this)),
+      m_idleTimer(QElapsedTimer()) {
+  // Unbuffered, since the ring is already a buffer
+  open(QIODevice::ReadWrite | QIODevice::Unbuffered);
+  connect(m_doorbellNotifier, &QSocketNotifier::activated, this,
+          &SharedMemoryTransport::onDoorbell);
+  connect(m_pollTimer, &QTimer::timeout, this, &SharedMemoryTransport::poll);
+  m_pollTimer->start(0);
+  m_idleTimer.start();
+}
+
+SharedMemoryTransport::~SharedMemoryTransport() {
+#ifdef Q_OS_UNIX
+  ::close(m_doorbellFd);
+  ::close(m_doorbellWriteFd);
+  unlink(m_region->doorbellPath);
+  munmap(m_region, sizeof(SharedMemoryRegion));
+  shm_unlink(m_name.toUtf8().constData());
+#endif
+}
+
+QString SharedMemoryTransport::getName() const { return m_name; }
+
+bool SharedMemoryTransport::isSequential() const { return true; }
+
+qint64 SharedMemoryTransport::bytesAvailable() const {
+  return QIODevice::bytesAvailable() + m_region->commands.numQueued();
+}
+
+qint64 SharedMemoryTransport::readData(char *data, qint64 maxSize) {
+  return m_region->commands.read(
+      data, static_cast<uint32_t>(qMin<qint64>(maxSize, UINT32_MAX)));
+}
+
+qint64 SharedMemoryTransport::writeData(const char *data, qint64 maxSize) {
+  // Never fails, responses that don't fit are kept in order until they do
+  m_pendingResponses.append(data, maxSize);
+  flushPendingResponses();
+  return maxSize;
+}
+
+void SharedMemoryTransport::poll() {
+  flushPendingResponses();
+  if (m_region->commands.numQueued() > 0) {
+    m_idleTimer.start();
+    m_pollTimer->setInterval(0);
+    emit readyRead();
+  } else if (m_idleTimer.nsecsElapsed() < IDLE_NANOS_BEFORE_SLEEP) {
+    // Keep spinning, the next command is usually right behind
+  } else if (!m_pendingResponses.isEmpty()) {
+    // There's no doorbell for room in the response ring, which only runs out
+    // if the algorithm stops reading
+    m_pollTimer->setInterval(1);
+  } else {
+    goToSleep();
+  }
+}
+
+void SharedMemoryTransport::goToSleep() {
+  // The mirror image of SharedMemoryRegion::shouldRingDoorbell
+  m_region->isSimulatorAsleep.store(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (m_region->commands.numQueued() > 0) {
+    // The algorithm might not ring, since it might have missed the flag
+    m_region->isSimulatorAsleep.store(0, std::memory_order_relaxed);
+    m_idleTimer.start();
+    return;
+  }
+  m_pollTimer->stop();
+}
+
+void SharedMemoryTransport::onDoorbell() {
+#ifdef Q_OS_UNIX
+  // Rings that come in while awake are harmless, they only restart polling
+  char buffer[64];
+  while (::read(m_doorbellFd, buffer, sizeof(buffer)) > 0) {
+  }
+#endif
+  m_region->isSimulatorAsleep.store(0, std::memory_order_relaxed);
+  m_idleTimer.start();
+  m_pollTimer->start(0);
+}
+
+void SharedMemoryTransport::flushPendingResponses() {
+  if (m_pendingResponses.isEmpty()) {
+    return;
+  }
+  uint32_t written = m_region->responses.write(
+      m_pendingResponses.constData(),
+      static_cast<uint32_t>(m_pendingResponses.size()));
+  m_pendingResponses.remove(0, written);
+}
+
+}  // namespace mms
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QIODevice>
+#include <QObject>
+#include <QSocketNotifier>
+#include <QString>
+#include <QTimer>
+
+#include "SharedMemoryRing.h"
+
+namespace mms {
+
+// A local alternative to the algorithm's stdin/stdout, which avoids a pipe
+// syscall and a process signal for every command. The transport creates a
+// POSIX shared memory region (see SharedMemoryRegion), whose name is passed to
+// the algorithm in the NAME_VARIABLE environment variable. The algorithm maps
+// the region, writes commands to one ring, and reads responses from the other.
+//
+// The simulator polls the command ring from the event loop while commands are
+// arriving. Once the ring has been empty for IDLE_NANOS_BEFORE_SLEEP, it goes
+// to sleep until the algorithm rings the doorbell, a FIFO next to the region
+// (see SharedMemoryRegion::shouldRingDoorbell), so that an algorithm that's
+// busy thinking doesn't keep a core spinning, nor wait on a timer to be heard.
+class SharedMemoryTransport : public QIODevice {
+  Q_OBJECT
+
+ public:
+  static const char *NAME_VARIABLE;
+
+  // Returns nullptr if shared memory is unavailable on this platform or the
+  // region couldn't be created
+  static SharedMemoryTransport *create(QObject *parent = nullptr);
+  ~SharedMemoryTransport();
+
+  QString getName() const;
+
+  bool isSequential() const override;
+  qint64 bytesAvailable() const override;
+
+ protected:
+  qint64 readData(char *data, qint64 maxSize) override;
+  qint64 writeData(const char *data, qint64 maxSize) override;
+
+ private:
+  // How long to keep polling an empty ring before sleeping on the doorbell,
+  // which is 50 us: about the cost of the wakeup, so an algorithm that answers
+  // right away isn't slowed down, while one that thinks barely spins
+  static const qint64 IDLE_NANOS_BEFORE_SLEEP;
+
+  SharedMemoryTransport(const QString &name, SharedMemoryRegion *region,
+                        int doorbellFd, int doorbellWriteFd, QObject *parent);
+
+  QString m_name;
+  SharedMemoryRegion *m_region;
+
+  // The read end of the doorbell, and a write end that's only held so that
+  // the FIFO never reports end-of-file while the algorithm hasn't opened it
+  int m_doorbellFd;
+  int m_doorbellWriteFd;
+  QSocketNotifier *m_doorbellNotifier;
+
+  // Responses that didn't fit in the ring yet, written once there's room
+  QByteArray m_pendingResponses;
+
+  QTimer *m_pollTimer;
+
+  // Restarted whenever commands arrive
+  QElapsedTimer m_idleTimer;
+
+  void poll();
+  void goToSleep();
+  void onDoorbell();
+  void flushPendingResponses();
+};
+
+}  // namespace mms
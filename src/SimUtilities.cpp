@@ -1,13 +1,17 @@
 #include "SimUtilities.h"
 
-#include <QDateTime>
+#include <QElapsedTimer>
 
 #include "AssertMacros.h"
 
 namespace mms {
 
 double SimUtilities::getHighResTimestamp() {
-  return QDateTime::currentDateTime().toMSecsSinceEpoch() / 1000.0;
+  static QElapsedTimer timer;
+  if (!timer.isValid()) {
+    timer.start();
+  }
+  return timer.nsecsElapsed() / 1e9;
 }
 
 QVector<TriangleGraphic> SimUtilities::polygonToTriangleGraphics(
@@ -15,7 +15,8 @@ class SimUtilities {
   // The SimUtilities class is not constructible
   SimUtilities() = delete;
 
-  // Like time() in <ctime> but higher resolution (returns seconds since epoch)
+  // Monotonic wall-clock seconds since an arbitrary fixed point, for pacing
+  // the graphics only; simulated durations come from the SimulationClock
   static double getHighResTimestamp();
 
   // Converts a polygon to a vector of triangle graphics
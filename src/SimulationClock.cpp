@@ -0,0 +1,39 @@
+#include "SimulationClock.h"
+
+#include <cmath>
+
+#include "AssertMacros.h"
+
+namespace mms {
+
+SimulationClock::SimulationClock() : m_now(0.0), m_realTimeFactor(1.0) {}
+
+double SimulationClock::now() const { return m_now; }
+
+void SimulationClock::advance(double robotSeconds) {
+  ASSERT_LE(0.0, robotSeconds);
+  m_now += robotSeconds;
+}
+
+void SimulationClock::reset() { m_now = 0.0; }
+
+double SimulationClock::getRealTimeFactor() const { return m_realTimeFactor; }
+
+void SimulationClock::setRealTimeFactor(double realTimeFactor) {
+  ASSERT_LT(0.0, realTimeFactor);
+  m_realTimeFactor = realTimeFactor;
+}
+
+bool SimulationClock::isUnbounded() const {
+  return std::isinf(m_realTimeFactor);
+}
+
+double SimulationClock::toWallSeconds(double robotSeconds) const {
+  return robotSeconds / m_realTimeFactor;
+}
+
+double SimulationClock::toRobotSeconds(double wallSeconds) const {
+  return wallSeconds * m_realTimeFactor;
+}
+
+}  // namespace mms
@@ -0,0 +1,32 @@
+#pragma once
+
+namespace mms {
+
+// Keeps track of "robot time", the time that the mouse would have spent moving
+// if it were real. Robot time only advances as movements make progress, so it
+// doesn't depend on how fast the host machine is or how often the event loop
+// gets around to processing commands. The real-time factor determines how much
+// robot time passes per wall-clock second; infinity means as fast as possible.
+class SimulationClock {
+ public:
+  SimulationClock();
+
+  // Robot seconds since the last reset
+  double now() const;
+  void advance(double robotSeconds);
+  void reset();
+
+  double getRealTimeFactor() const;
+  void setRealTimeFactor(double realTimeFactor);
+  bool isUnbounded() const;
+
+  // Conversions between robot time and wall-clock time at the current factor
+  double toWallSeconds(double robotSeconds) const;
+  double toRobotSeconds(double wallSeconds) const;
+
+ private:
+  double m_now;
+  double m_realTimeFactor;
+};
+
+}  // namespace mms
@@ -0,0 +1,1352 @@
+#include "SimulationEngine.h"
+
+#include <QtMath>
+#include <ctime>
+
+#include "AssertMacros.h"
+#include "BinaryProtocol.h"
+#include "Color.h"
+#include "Dimensions.h"
+#include "FontImage.h"
+#include "TextProtocol.h"
+
+namespace mms {
+
+const double SimulationEngine::MAX_SLEEP_SECONDS = 0.008;
+const double SimulationEngine::ROBOT_PROGRESS_PER_SECOND = 500.0;
+
+const SemiPosition SimulationEngine::INITIAL_STARTING_POSITION = {1, 1};
+const SemiDirection SimulationEngine::INITIAL_STARTING_DIRECTION =
+    SemiDirection::NORTH;
+
+SimulationEngine::SimulationEngine(QObject *parent)
+    : QObject(parent),
+
+      // Run state
+      m_maze(nullptr),
+      m_mouse(nullptr),
+      m_view(nullptr),
+      m_stats(new Stats(this)),
+      m_device(nullptr),
+
+      // Pause/reset
+      m_isPaused(false),
+      m_wasReset(false),
+      m_resetSubscribed(false),
+
+      // Communication
+      m_inputBuffer(QByteArray()),
+      m_outputBuffer(QByteArray()),
+      m_isReceiving(false),
+      m_binaryInput(false),
+      m_binaryOutput(false),
+      m_sensing(false),
+      m_sharedMemoryEnabled(false),
+      m_transport(nullptr),
+      m_traceWriter(nullptr),
+      m_recordedClock(nullptr),
+      m_commandQueue(QQueue<Command>()),
+      m_commandQueueTimer(new QTimer(this)),
+      m_numCommands(0),
+      m_commandCpuSeconds(0.0),
+      m_latency(CommandLatency()),
+      m_timeline(RunTimeline()),
+      m_runTimer(QElapsedTimer()),
+      m_runTimerOffsetMicros(0),
+      m_answered(QVector<QPair<CommandType, qint64>>()),
+      m_lastAnswered(CommandType::INVALID),
+      m_lastAnsweredMicros(0),
+      m_isThinking(false),
+      m_motionIndex(0),
+      m_motionCrashed(false),
+
+      // Movement
+      m_startingPosition(INITIAL_STARTING_POSITION),
+      m_startingDirection(INITIAL_STARTING_DIRECTION),
+      m_movement(Movement::NONE),
+      m_doomedToCrash(false),
+      m_corridorHalfSteps(0),
+      m_halfStepsToMoveForward(0),
+      m_movementProgress(0.0),
+      m_movementStepSize(0.0),
+      m_clock(SimulationClock()),
+
+      // Helpers
+      m_tilesWithColor(QSet<QPair<int, int>>()),
+      m_tilesWithText(QSet<QPair<int, int>>()) {
+  // Configure command queue timer
+  m_commandQueueTimer->setSingleShot(true);
+  connect(m_commandQueueTimer, &QTimer::timeout, this,
+          &SimulationEngine::processQueuedCommands);
+}
+
+SimulationEngine::~SimulationEngine() { delete m_mouse; }
+
+void SimulationEngine::setMaze(const Maze *maze) {
+  ASSERT_TR(m_mouse == nullptr);
+  m_maze = maze;
+}
+
+void SimulationEngine::startRun(QIODevice *device, MazeView *view,
+                                const RecordedClock *recordedClock) {
+  ASSERT_FA(m_maze == nullptr);
+  ASSERT_TR(m_mouse == nullptr);
+  m_mouse = new Mouse();
+  m_view = view;
+  m_device = device;
+  m_recordedClock = recordedClock;
+  m_clock.reset();
+  m_binaryInput = false;
+  m_binaryOutput = false;
+  m_sensing = false;
+  m_numCommands = 0;
+  m_commandCpuSeconds = 0.0;
+  m_latency.clear();
+  m_timeline.clear();
+  m_runTimer.start();
+  m_runTimerOffsetMicros = 0;
+  m_lastAnswered = CommandType::INVALID;
+  m_isThinking = false;
+
+  if (m_sharedMemoryEnabled) {
+    ASSERT_TR(m_transport == nullptr);
+    m_transport = SharedMemoryTransport::create(this);
+    if (m_transport != nullptr) {
+      connect(m_transport, &QIODevice::readyRead, this, [=]() {
+        m_device = m_transport;
+        receiveCommands(m_transport->readAll());
+      });
+    }
+  }
+}
+
+void SimulationEngine::setSharedMemoryEnabled(bool enabled) {
+  m_sharedMemoryEnabled = enabled;
+}
+
+QString SimulationEngine::getSharedMemoryName() const {
+  return m_transport == nullptr ? QString() : m_transport->getName();
+}
+
+void SimulationEngine::setTraceWriter(TraceWriter *writer) {
+  m_traceWriter = writer;
+}
+
+void SimulationEngine::stopRun() {
+  // Stop consuming queued commands
+  m_commandQueueTimer->stop();
+  m_commandQueue.clear();
+  m_motionIndex = 0;
+  m_motionCrashed = false;
+  m_outputBuffer.clear();
+  m_answered.clear();
+  m_isThinking = false;
+  m_device = nullptr;
+  if (m_transport != nullptr) {
+    // Might be in the middle of delivering commands
+    disconnect(m_transport, nullptr, this, nullptr);
+    m_transport->deleteLater();
+    m_transport = nullptr;
+  }
+  m_isPaused = false;
+  m_wasReset = false;
+  m_resetSubscribed = false;
+}
+
+void SimulationEngine::removeMouse() {
+  // Delete the mouse, drop the view
+  delete m_mouse;
+  m_mouse = nullptr;
+  m_view = nullptr;
+
+  // Reset communication state
+  m_inputBuffer.clear();
+
+  // Reset movement state
+  resetMovement();
+
+  // Reset other mouse state
+  m_tilesWithColor.clear();
+  m_tilesWithText.clear();
+}
+
+const Mouse *SimulationEngine::getMouse() const { return m_mouse; }
+
+Stats *SimulationEngine::getStats() const { return m_stats; }
+
+const SimulationClock *SimulationEngine::getClock() const { return &m_clock; }
+
+void SimulationEngine::setRealTimeFactor(double realTimeFactor) {
+  m_clock.setRealTimeFactor(realTimeFactor);
+}
+
+bool SimulationEngine::isPaused() const { return m_isPaused; }
+
+void SimulationEngine::setPaused(bool paused) {
+  m_isPaused = paused;
+  if (!m_isPaused) {
+    processQueuedCommands();
+  }
+}
+
+void SimulationEngine::requestReset() {
+  if (m_traceWriter != nullptr) {
+    m_traceWriter->record(TraceKind::RESET, QByteArrayView());
+  }
+  m_wasReset = true;
+  // Written between responses, never in the middle of one
+  if (m_resetSubscribed && !m_binaryOutput && m_device != nullptr) {
+    respond({ResponseType::EVENT, 0, QString("reset")});
+    flushResponses();
+  }
+}
+
+void SimulationEngine::receiveCommands(const QByteArray &bytes) {
+  receiveCommands(bytes, getRunMicros());
+}
+
+void SimulationEngine::receiveCommands(const QByteArray &bytes,
+                                       qint64 arrivalMicros) {
+  // Measured per batch rather than per command, so it's cheap enough to
+  // leave on; this covers parsing, dispatch, and execution
+  std::clock_t start = std::clock();
+  if (m_isThinking) {
+    m_latency.addThinkTime(m_lastAnswered,
+                           arrivalMicros - m_lastAnsweredMicros);
+    m_isThinking = false;
+  }
+  if (m_traceWriter != nullptr) {
+    m_traceWriter->record(TraceKind::COMMANDS, bytes);
+  }
+  m_isReceiving = true;
+  m_inputBuffer.append(bytes);
+  int offset = 0;
+  while (offset < m_inputBuffer.size()) {
+    Command command;
+    int consumed = 0;
+    if (m_binaryInput) {
+      consumed = BinaryProtocol::decode(m_inputBuffer.constData() + offset,
+                                        m_inputBuffer.size() - offset,
+                                        &command);
+    } else {
+      // Only process text once terminated with a newline
+      int newline = m_inputBuffer.indexOf('\n', offset);
+      if (newline != -1) {
+        command = TextProtocol::parse(QByteArrayView(
+            m_inputBuffer.constData() + offset, newline - offset));
+        consumed = newline + 1 - offset;
+      }
+    }
+    if (consumed == 0) {
+      break;
+    }
+    offset += consumed;
+
+    // Everything after the handshake is binary
+    if (command.type == CommandType::USE_BINARY_PROTOCOL) {
+      m_binaryInput = true;
+    }
+    command.arrivalMicros = arrivalMicros;
+    dispatchCommand(command);
+    m_numCommands += 1;
+  }
+  m_inputBuffer.remove(0, offset);
+  m_isReceiving = false;
+  flushResponses();
+  m_commandCpuSeconds +=
+      static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+}
+
+bool SimulationEngine::isIdle() const { return m_commandQueue.isEmpty(); }
+
+RunSnapshot SimulationEngine::saveSnapshot() const {
+  ASSERT_TR(isIdle());
+  ASSERT_TR(m_movement == Movement::NONE);
+  RunSnapshot snapshot;
+  snapshot.mouseTranslation = m_mouse->getCurrentTranslation();
+  snapshot.mouseRotation = m_mouse->getCurrentRotation();
+  snapshot.startingPosition = m_startingPosition;
+  snapshot.startingDirection = m_startingDirection;
+  snapshot.robotSeconds = m_clock.now();
+  snapshot.stats = m_stats->getState();
+  if (m_view != nullptr) {
+    snapshot.tiles = m_view->getMazeGraphic()->getTileStates();
+  }
+  snapshot.tilesWithColor = m_tilesWithColor;
+  snapshot.tilesWithText = m_tilesWithText;
+  snapshot.inputBuffer = m_inputBuffer;
+  snapshot.wasReset = m_wasReset;
+  snapshot.resetSubscribed = m_resetSubscribed;
+  snapshot.binaryInput = m_binaryInput;
+  snapshot.binaryOutput = m_binaryOutput;
+  snapshot.sensing = m_sensing;
+  snapshot.numCommands = m_numCommands;
+  snapshot.commandCpuSeconds = m_commandCpuSeconds;
+  snapshot.latency = m_latency;
+  snapshot.timeline = m_timeline.getState();
+  snapshot.runMicros = getRunMicros();
+  snapshot.lastAnswered = m_lastAnswered;
+  snapshot.lastAnsweredMicros = m_lastAnsweredMicros;
+  snapshot.isThinking = m_isThinking;
+  return snapshot;
+}
+
+void SimulationEngine::restoreSnapshot(const RunSnapshot &snapshot) {
+  // Abandon whatever was in progress
+  m_commandQueueTimer->stop();
+  m_commandQueue.clear();
+  m_motionIndex = 0;
+  m_motionCrashed = false;
+  m_outputBuffer.clear();
+  m_answered.clear();
+  m_isThinking = false;
+  resetMovement();
+
+  m_mouse->teleport(snapshot.mouseTranslation, snapshot.mouseRotation);
+  m_startingPosition = snapshot.startingPosition;
+  m_startingDirection = snapshot.startingDirection;
+  m_clock.reset();
+  m_clock.advance(snapshot.robotSeconds);
+  m_stats->setState(snapshot.stats);
+  if (m_view != nullptr) {
+    m_view->getMazeGraphic()->setTileStates(snapshot.tiles);
+  }
+  m_tilesWithColor = snapshot.tilesWithColor;
+  m_tilesWithText = snapshot.tilesWithText;
+  m_inputBuffer = snapshot.inputBuffer;
+  m_wasReset = snapshot.wasReset;
+  m_resetSubscribed = snapshot.resetSubscribed;
+  m_binaryInput = snapshot.binaryInput;
+  m_binaryOutput = snapshot.binaryOutput;
+  m_sensing = snapshot.sensing;
+  m_numCommands = snapshot.numCommands;
+  m_commandCpuSeconds = snapshot.commandCpuSeconds;
+  m_latency = snapshot.latency;
+  m_timeline.rewind(snapshot.timeline);
+  m_runTimer.start();
+  m_runTimerOffsetMicros = snapshot.runMicros;
+  m_lastAnswered = snapshot.lastAnswered;
+  m_lastAnsweredMicros = snapshot.lastAnsweredMicros;
+  m_isThinking = snapshot.isThinking;
+}
+
+qint64 SimulationEngine::getNumCommands() const { return m_numCommands; }
+
+double SimulationEngine::getCommandCpuSeconds() const {
+  return m_commandCpuSeconds;
+}
+
+const CommandLatency *SimulationEngine::getLatency() const {
+  return &m_latency;
+}
+
+const RunTimeline *SimulationEngine::getTimeline() const { return &m_timeline; }
+
+qint64 SimulationEngine::getRunMicros() const {
+  if (!m_runTimer.isValid()) {
+    return 0;
+  }
+  return m_runTimerOffsetMicros + m_runTimer.nsecsElapsed() / 1000;
+}
+
+void SimulationEngine::dispatchCommand(const Command &command) {
+  // For performance reasons, handle no-response commands inline (don't queue
+  // them with the commands that elicit a response, just perform the action)
+  switch (command.type) {
+    case CommandType::SET_WALL:
+      setWall(command.x, command.y, command.c);
+      break;
+    case CommandType::CLEAR_WALL:
+      clearWall(command.x, command.y, command.c);
+      break;
+    case CommandType::SET_COLOR:
+      setColor(command.x, command.y, command.c);
+      break;
+    case CommandType::CLEAR_COLOR:
+      clearColor(command.x, command.y);
+      break;
+    case CommandType::CLEAR_ALL_COLOR:
+      clearAllColor();
+      break;
+    case CommandType::SET_TEXT:
+      setText(command.x, command.y, command.text);
+      break;
+    case CommandType::CLEAR_TEXT:
+      clearText(command.x, command.y);
+      break;
+    case CommandType::CLEAR_ALL_TEXT:
+      clearAllText();
+      break;
+    case CommandType::SET_COLORS:
+      setColors(command.x, command.y, command.width, command.height,
+                command.text);
+      break;
+    case CommandType::SET_TEXTS:
+      setTexts(command.x, command.y, command.width, command.height,
+               command.text);
+      break;
+    case CommandType::SET_WALLS:
+      setWalls(command.text);
+      break;
+    case CommandType::MARK:
+      m_timeline.addMark(command.text, command.arrivalMicros);
+      break;
+    case CommandType::SPAN_BEGIN:
+      m_timeline.beginSpan(command.text, command.arrivalMicros);
+      break;
+    case CommandType::SPAN_END:
+      m_timeline.endSpan(command.text, command.arrivalMicros);
+      break;
+    case CommandType::INVALID:
+      // Drop all invalid commands on the floor
+      break;
+    default:
+      // Enqueue the serial command, process it if
+      // future processing is not already scheduled
+      m_commandQueue.enqueue(command);
+      if (!m_commandQueueTimer->isActive()) {
+        processQueuedCommands();
+      }
+  }
+}
+
+Response SimulationEngine::executeCommand(const Command &command) {
+  // The "wallFront" and such methods take "halfStepsAhead", which represents
+  // the number of moves "ahead" of the current move to simulate before
+  // checking if a wall is a half-step away. To check if a wall is directly in
+  // front of the mouse, we provide halfStepsAhead=0. The potential wall would
+  // be 1 half-step away, which is a bit more intuitive from the perspective of
+  // the API, hence the -1 here.
+  int halfStepsAhead = command.n - 1;
+  switch (command.type) {
+    case CommandType::MAZE_WIDTH:
+      return {ResponseType::INTEGER, mazeWidth()};
+    case CommandType::MAZE_HEIGHT:
+      return {ResponseType::INTEGER, mazeHeight()};
+    case CommandType::WALL_FRONT:
+      return {ResponseType::BOOLEAN, wallFront(halfStepsAhead)};
+    case CommandType::WALL_BACK:
+      return {ResponseType::BOOLEAN, wallBack(halfStepsAhead)};
+    case CommandType::WALL_LEFT:
+      return {ResponseType::BOOLEAN, wallLeft(halfStepsAhead)};
+    case CommandType::WALL_RIGHT:
+      return {ResponseType::BOOLEAN, wallRight(halfStepsAhead)};
+    case CommandType::WALL_FRONT_RIGHT:
+      return {ResponseType::BOOLEAN, wallFrontRight(halfStepsAhead)};
+    case CommandType::WALL_FRONT_LEFT:
+      return {ResponseType::BOOLEAN, wallFrontLeft(halfStepsAhead)};
+    case CommandType::WALL_BACK_RIGHT:
+      return {ResponseType::BOOLEAN, wallBackRight(halfStepsAhead)};
+    case CommandType::WALL_BACK_LEFT:
+      return {ResponseType::BOOLEAN, wallBackLeft(halfStepsAhead)};
+    case CommandType::WALLS:
+      return {ResponseType::WALLS, walls(halfStepsAhead)};
+    case CommandType::MOVE_FORWARD:
+      return {moveForward(command.n * 2) ? ResponseType::PENDING
+                                         : ResponseType::CRASH};
+    case CommandType::MOVE_FORWARD_HALF:
+      return {moveForward(command.n) ? ResponseType::PENDING
+                                     : ResponseType::CRASH};
+    case CommandType::TURN_RIGHT_90:
+      turn(Movement::TURN_RIGHT_90);
+      return {ResponseType::PENDING};
+    case CommandType::TURN_LEFT_90:
+      turn(Movement::TURN_LEFT_90);
+      return {ResponseType::PENDING};
+    case CommandType::TURN_RIGHT_45:
+      turn(Movement::TURN_RIGHT_45);
+      return {ResponseType::PENDING};
+    case CommandType::TURN_LEFT_45:
+      turn(Movement::TURN_LEFT_45);
+      return {ResponseType::PENDING};
+    case CommandType::MOVES:
+    case CommandType::MOVES_SUMMARY: {
+      // Motions after a crash aren't attempted
+      if (m_motionCrashed) {
+        return {ResponseType::CRASH};
+      }
+      Command motion;
+      motion.type = command.motions.at(m_motionIndex).type;
+      motion.n = command.motions.at(m_motionIndex).n;
+      return executeCommand(motion);
+    }
+    case CommandType::MOVE_UNTIL_WALL:
+    case CommandType::MOVE_UNTIL_OPENING:
+      // Answered with the length once the movement completes
+      m_corridorHalfSteps = corridorLength(command.c);
+      if (m_corridorHalfSteps == 0) {
+        return {ResponseType::INTEGER, 0};
+      }
+      moveForward(m_corridorHalfSteps);
+      return {ResponseType::PENDING};
+    case CommandType::WAS_RESET:
+      return {ResponseType::BOOLEAN, wasReset()};
+    case CommandType::ACK_RESET:
+      ackReset();
+      return {ResponseType::ACK};
+    case CommandType::SUBSCRIBE:
+      // A binary event couldn't be told apart from the bytes of a response
+      if (m_binaryOutput) {
+        return {ResponseType::BOOLEAN, false};
+      }
+      m_resetSubscribed = true;
+      return {ResponseType::ACK};
+    case CommandType::GET_STAT:
+      return {ResponseType::STAT, 0,
+              m_stats->getStat(static_cast<StatsEnum>(command.n))};
+    case CommandType::USE_SENSING:
+      m_sensing = true;
+      return {ResponseType::ACK};
+    case CommandType::USE_BINARY_PROTOCOL:
+      return {ResponseType::ACK};
+    case CommandType::END_RUN:
+      // Answered by the runner, once it has the final stats
+      emit runEnded();
+      return {ResponseType::INVALID};
+    default:
+      return {ResponseType::INVALID};
+  }
+}
+
+void SimulationEngine::processQueuedCommands() {
+  while (!m_commandQueue.isEmpty() && !m_isPaused) {
+    Response response = {ResponseType::PENDING};
+    if (isMoving()) {
+      if (hasUnboundedSpeed()) {
+        // Nothing to animate, finish the movement in a single step
+        m_movementStepSize = progressRequired(m_movement) - m_movementProgress;
+      }
+      updateMouseProgress(m_movementStepSize);
+      if (!isMoving()) {
+        CommandType type = m_commandQueue.head().type;
+        if (m_doomedToCrash) {
+          response = {ResponseType::CRASH};
+        } else if (type == CommandType::MOVE_UNTIL_WALL ||
+                   type == CommandType::MOVE_UNTIL_OPENING) {
+          response = {ResponseType::INTEGER, m_corridorHalfSteps};
+        } else if (m_sensing) {
+          response = {ResponseType::ACK_WALLS, walls(0)};
+        } else {
+          response = {ResponseType::ACK};
+        }
+      }
+    } else {
+      response = executeCommand(m_commandQueue.head());
+    }
+    if (response.type == ResponseType::PENDING) {
+      if (hasUnboundedSpeed()) {
+        // Complete the movement right away instead of waiting on the timer
+        continue;
+      }
+      scheduleMouseProgressUpdate();
+      break;
+    }
+    // Scripts stay at the head of the queue until every motion is done, so
+    // the next motion starts without waiting on the algorithm
+    CommandType type = m_commandQueue.head().type;
+    bool done = true;
+    if (type == CommandType::MOVES || type == CommandType::MOVES_SUMMARY) {
+      done = advanceMotionScript(&response);
+    }
+    if (response.type != ResponseType::INVALID) {
+      respond(response);
+    }
+    if (!done) {
+      continue;
+    }
+    if (response.type != ResponseType::INVALID) {
+      m_answered.append(QPair<CommandType, qint64>(
+          m_commandQueue.head().type, m_commandQueue.head().arrivalMicros));
+    }
+    // The handshake itself is answered in text
+    if (m_commandQueue.dequeue().type == CommandType::USE_BINARY_PROTOCOL) {
+      m_binaryOutput = true;
+    }
+  }
+  if (!m_isReceiving) {
+    flushResponses();
+  }
+}
+
+void SimulationEngine::respond(const Response &response) {
+  m_outputBuffer.append(m_binaryOutput ? BinaryProtocol::encode(response)
+                                       : TextProtocol::encode(response));
+}
+
+void SimulationEngine::flushResponses() {
+  if (!m_outputBuffer.isEmpty() && m_device != nullptr) {
+    if (m_traceWriter != nullptr) {
+      m_traceWriter->record(TraceKind::RESPONSES, m_outputBuffer);
+    }
+    m_device->write(m_outputBuffer);
+
+    // Measured once the responses are actually out
+    qint64 writtenMicros = m_recordedClock != nullptr
+                               ? m_recordedClock->getResponseMicros()
+                               : getRunMicros();
+    for (const auto &answered : m_answered) {
+      m_latency.addServiceTime(answered.first, writtenMicros - answered.second);
+      if (isMovement(answered.first)) {
+        m_timeline.addMovement(answered.first, answered.second, writtenMicros);
+      }
+    }
+    if (!m_answered.isEmpty()) {
+      m_lastAnswered = m_answered.last().first;
+      m_lastAnsweredMicros = writtenMicros;
+      m_isThinking = true;
+    }
+  }
+  m_outputBuffer.clear();
+  m_answered.clear();
+}
+
+bool SimulationEngine::advanceMotionScript(Response *response) {
+  const Command &script = m_commandQueue.head();
+  bool crashed = response->type == ResponseType::CRASH;
+  m_motionIndex += 1;
+  bool done = m_motionIndex == script.motions.size();
+  if (script.type == CommandType::MOVES_SUMMARY) {
+    // A single response, the number of motions completed before any crash
+    done = done || crashed;
+    if (done) {
+      *response = {ResponseType::INTEGER,
+                   crashed ? m_motionIndex - 1 : m_motionIndex};
+    } else {
+      *response = {ResponseType::INVALID};
+    }
+  } else if (crashed) {
+    // Every remaining motion is answered with a crash
+    m_motionCrashed = true;
+  }
+  if (done) {
+    m_motionIndex = 0;
+    m_motionCrashed = false;
+  }
+  return done;
+}
+
+double SimulationEngine::progressRequired(Movement movement) {
+  switch (movement) {
+    case Movement::MOVE_STRAIGHT:
+      return 50.0 * m_halfStepsToMoveForward;
+    case Movement::MOVE_DIAGONAL:
+      return 70.71 * m_halfStepsToMoveForward;
+    case Movement::TURN_RIGHT_45:
+    case Movement::TURN_LEFT_45:
+      return 16.66;
+    case Movement::TURN_RIGHT_90:
+    case Movement::TURN_LEFT_90:
+      return 33.33;
+    default:
+      ASSERT_NEVER_RUNS();
+  }
+}
+
+void SimulationEngine::updateMouseProgress(double progress) {
+  // Determine the destination of the mouse.
+  SemiPosition destinationLocation = m_startingPosition;
+  Angle destinationRotation = DIRECTION_TO_ANGLE().value(m_startingDirection);
+  if (m_movement == Movement::MOVE_STRAIGHT) {
+    if (m_startingDirection == SemiDirection::NORTH) {
+      destinationLocation.y += m_halfStepsToMoveForward;
+    } else if (m_startingDirection == SemiDirection::EAST) {
+      destinationLocation.x += m_halfStepsToMoveForward;
+    } else if (m_startingDirection == SemiDirection::SOUTH) {
+      destinationLocation.y -= m_halfStepsToMoveForward;
+    } else if (m_startingDirection == SemiDirection::WEST) {
+      destinationLocation.x -= m_halfStepsToMoveForward;
+    } else {
+      ASSERT_NEVER_RUNS();
+    }
+  } else if (m_movement == Movement::MOVE_DIAGONAL) {
+    if (m_startingDirection == SemiDirection::NORTHEAST) {
+      destinationLocation.x += m_halfStepsToMoveForward;
+      destinationLocation.y += m_halfStepsToMoveForward;
+    } else if (m_startingDirection == SemiDirection::NORTHWEST) {
+      destinationLocation.x -= m_halfStepsToMoveForward;
+      destinationLocation.y += m_halfStepsToMoveForward;
+    } else if (m_startingDirection == SemiDirection::SOUTHEAST) {
+      destinationLocation.x += m_halfStepsToMoveForward;
+      destinationLocation.y -= m_halfStepsToMoveForward;
+    } else if (m_startingDirection == SemiDirection::SOUTHWEST) {
+      destinationLocation.x -= m_halfStepsToMoveForward;
+      destinationLocation.y -= m_halfStepsToMoveForward;
+    } else {
+      ASSERT_NEVER_RUNS();
+    }
+  }
+  // Explicity add or subtract depending on direction so that the mouse is
+  // guaranteed to only rotate that much (using DIRECTION_ROTATE can cause
+  // the mouse to rotate 270 degrees in the opposite direction in some cases)
+  else if (m_movement == Movement::TURN_RIGHT_45) {
+    destinationRotation -= Angle::Degrees(45);
+  } else if (m_movement == Movement::TURN_LEFT_45) {
+    destinationRotation += Angle::Degrees(45);
+  } else if (m_movement == Movement::TURN_RIGHT_90) {
+    destinationRotation -= Angle::Degrees(90);
+  } else if (m_movement == Movement::TURN_LEFT_90) {
+    destinationRotation += Angle::Degrees(90);
+  } else {
+    ASSERT_NEVER_RUNS();
+  }
+
+  // Increment the movement progress and robot time, calculate fraction
+  // complete
+  double required = progressRequired(m_movement);
+  progress = qMin(progress, required - m_movementProgress);
+  m_clock.advance(progress / ROBOT_PROGRESS_PER_SECOND);
+  m_movementProgress += progress;
+  double remaining = required - m_movementProgress;
+  if (remaining < 0) {
+    remaining = 0;
+  }
+  double fraction = 1.0 - (remaining / required);
+
+  // Calculate the current translation and rotation
+  Coordinate startingTranslation = getCoordinate(m_startingPosition);
+  Coordinate destinationTranslation = getCoordinate(destinationLocation);
+
+  Angle startingRotation = DIRECTION_TO_ANGLE().value(m_startingDirection);
+  Coordinate currentTranslation = startingTranslation * (1.0 - fraction) +
+                                  destinationTranslation * fraction;
+  Angle currentRotation =
+      startingRotation * (1.0 - fraction) + destinationRotation * fraction;
+
+  // Teleport the mouse, reset movement state if done
+  m_mouse->teleport(currentTranslation, currentRotation);
+  if (remaining == 0.0) {
+    m_startingPosition = m_mouse->getCurrentDiscretizedTranslation();
+    m_startingDirection = m_mouse->getCurrentDiscretizedRotation();
+    m_movementProgress = 0.0;
+    m_movementStepSize = 0.0;
+    m_movement = Movement::NONE;
+    m_halfStepsToMoveForward = 0;
+    // TODO: upforgrabs
+    // This if-else can probably be moved outside of the enclosing if-block
+    // determine if the goal was reached
+    if (m_maze->isInCenter(m_startingPosition.toMazeLocation())) {
+      m_stats->finishRun();  // record a completed start-to-finish run
+    } else if (m_startingPosition.toMazeLocation().first == 0 &&
+               m_startingPosition.toMazeLocation().second == 0) {
+      m_stats->endUnfinishedRun();
+    }
+  }
+}
+
+void SimulationEngine::scheduleMouseProgressUpdate() {
+  // Calculate progressRemaining, should be nonzero
+  double required = progressRequired(m_movement);
+  double progressRemaining = required - m_movementProgress;
+  ASSERT_LT(0.0, progressRemaining);
+
+  // Determine wall-clock seconds remaining; the step size depends only on
+  // the real-time factor, not on when the timer actually fires
+  double secondsRemaining = m_clock.toWallSeconds(
+      progressRemaining / ROBOT_PROGRESS_PER_SECOND);
+  if (secondsRemaining > MAX_SLEEP_SECONDS) {
+    secondsRemaining = MAX_SLEEP_SECONDS;
+    progressRemaining =
+        m_clock.toRobotSeconds(secondsRemaining) * ROBOT_PROGRESS_PER_SECOND;
+  }
+
+  // Update step size, set the timer
+  m_movementStepSize = progressRemaining;
+  m_commandQueueTimer->start(secondsRemaining * 1000);
+}
+
+bool SimulationEngine::isMoving() { return m_movement != Movement::NONE; }
+
+bool SimulationEngine::hasUnboundedSpeed() const {
+  return m_clock.isUnbounded();
+}
+
+void SimulationEngine::resetMovement() {
+  m_startingPosition = INITIAL_STARTING_POSITION;
+  m_startingDirection = INITIAL_STARTING_DIRECTION;
+  m_movement = Movement::NONE;
+  m_movementProgress = 0.0;
+  m_movementStepSize = 0.0;
+}
+
+int SimulationEngine::mazeWidth() { return m_maze->getWidth(); }
+
+int SimulationEngine::mazeHeight() { return m_maze->getHeight(); }
+
+bool SimulationEngine::wallFront(int halfStepsAhead) {
+  return isWall(m_mouse->getCurrentDiscretizedTranslation(),
+                m_mouse->getCurrentDiscretizedRotation(), halfStepsAhead);
+}
+
+bool SimulationEngine::wallRight(int halfStepsAhead) {
+  return isWall(m_mouse->getCurrentDiscretizedTranslation(),
+                DIRECTION_ROTATE_90_RIGHT().value(
+                    m_mouse->getCurrentDiscretizedRotation()),
+                halfStepsAhead);
+}
+
+bool SimulationEngine::wallLeft(int halfStepsAhead) {
+  return isWall(m_mouse->getCurrentDiscretizedTranslation(),
+                DIRECTION_ROTATE_90_LEFT().value(
+                    m_mouse->getCurrentDiscretizedRotation()),
+                halfStepsAhead);
+}
+
+bool SimulationEngine::wallBack(int halfStepsAhead) {
+  return isWall(
+      m_mouse->getCurrentDiscretizedTranslation(),
+      DIRECTION_ROTATE_180().value(m_mouse->getCurrentDiscretizedRotation()),
+      halfStepsAhead);
+}
+
+bool SimulationEngine::wallFrontRight(int halfStepsAhead) {
+  return isWall(m_mouse->getCurrentDiscretizedTranslation(),
+                DIRECTION_ROTATE_45_RIGHT().value(
+                    m_mouse->getCurrentDiscretizedRotation()),
+                halfStepsAhead);
+}
+
+bool SimulationEngine::wallFrontLeft(int halfStepsAhead) {
+  return isWall(m_mouse->getCurrentDiscretizedTranslation(),
+                DIRECTION_ROTATE_45_LEFT().value(
+                    m_mouse->getCurrentDiscretizedRotation()),
+                halfStepsAhead);
+}
+
+bool SimulationEngine::wallBackRight(int halfStepsAhead) {
+  return isWall(
+      m_mouse->getCurrentDiscretizedTranslation(),
+      DIRECTION_ROTATE_90_RIGHT().value(DIRECTION_ROTATE_45_RIGHT().value(
+          m_mouse->getCurrentDiscretizedRotation())),
+      halfStepsAhead);
+}
+
+bool SimulationEngine::wallBackLeft(int halfStepsAhead) {
+  return isWall(
+      m_mouse->getCurrentDiscretizedTranslation(),
+      DIRECTION_ROTATE_90_LEFT().value(DIRECTION_ROTATE_45_LEFT().value(
+          m_mouse->getCurrentDiscretizedRotation())),
+      halfStepsAhead);
+}
+
+int SimulationEngine::walls(int halfStepsAhead) {
+  bool values[] = {
+      wallFront(halfStepsAhead),      wallRight(halfStepsAhead),
+      wallBack(halfStepsAhead),       wallLeft(halfStepsAhead),
+      wallFrontRight(halfStepsAhead), wallFrontLeft(halfStepsAhead),
+      wallBackRight(halfStepsAhead),  wallBackLeft(halfStepsAhead),
+  };
+  int bitmask = 0;
+  for (int i = 0; i < 8; i += 1) {
+    if (values[i]) {
+      bitmask |= 1 << i;
+    }
+  }
+  return bitmask;
+}
+
+bool SimulationEngine::moveForward(int numHalfSteps) {
+  // Non-positive distances aren't allowed
+  if (numHalfSteps < 1) {
+    return false;
+  }
+  // Special case for a wall directly in front of the mouse, else
+  // the wall won't be detected until after the mouse starts moving
+  if (wallFront(0)) {
+    return false;
+  }
+
+  // Compute the number of allowable moves
+  int allowableHalfSteps = 1;
+  while (allowableHalfSteps < numHalfSteps) {
+    if (wallFront(allowableHalfSteps)) {
+      break;
+    }
+    allowableHalfSteps += 1;
+  }
+  m_doomedToCrash = (allowableHalfSteps != numHalfSteps);
+  m_halfStepsToMoveForward = allowableHalfSteps;
+
+  // Update m_movement based on current direction and requested steps
+  SemiDirection semiDir = m_mouse->getCurrentDiscretizedRotation();
+  if (!ORDINAL_DIRECTIONS().contains(semiDir)) {
+    m_movement = Movement::MOVE_STRAIGHT;
+  } else {
+    m_movement = Movement::MOVE_DIAGONAL;
+  }
+
+  // TODO: upforgrabs
+  // Starting position shouldn't be hardcoded here since it can depend on maze
+  if (m_startingPosition.toMazeLocation().first == 0 &&
+      m_startingPosition.toMazeLocation().second == 0) {
+    m_stats->startRun();
+  }
+  // TODO: upforgrabs
+  // Half steps shouldn't count as a full move
+  // increase the stats by the distance that will be travelled
+  m_stats->addDistance(numHalfSteps);
+
+  // Return true so that the allowable movement can be executed
+  return true;
+}
+
+int SimulationEngine::corridorLength(QChar side) {
+  SemiPosition semiPos = m_mouse->getCurrentDiscretizedTranslation();
+  SemiDirection semiDir = m_mouse->getCurrentDiscretizedRotation();
+  SemiDirection leftDir = DIRECTION_ROTATE_90_LEFT().value(semiDir);
+  SemiDirection rightDir = DIRECTION_ROTATE_90_RIGHT().value(semiDir);
+  // The sides of a diagonal are never open in the same sense
+  bool cardinal = !ORDINAL_DIRECTIONS().contains(semiDir);
+  bool checkLeft = cardinal && (side == 'L' || side == 'A');
+  bool checkRight = cardinal && (side == 'R' || side == 'A');
+
+  // The same scan as wallFront, one half-step at a time, and the maze
+  // is enclosed so it always ends at a wall
+  int halfSteps = 0;
+  while (!isWall(semiPos, semiDir)) {
+    semiPos = getNextPosition(semiPos, semiDir);
+    halfSteps += 1;
+    // Edges of cells have corner posts to either side, so an opening can
+    // only be found at the center of a cell
+    if ((checkLeft && !isWall(semiPos, leftDir)) ||
+        (checkRight && !isWall(semiPos, rightDir))) {
+      break;
+    }
+  }
+  return halfSteps;
+}
+
+void SimulationEngine::turn(Movement movement) {
+  ASSERT_TR(movement == Movement::TURN_LEFT_45 ||
+            movement == Movement::TURN_LEFT_90 ||
+            movement == Movement::TURN_RIGHT_45 ||
+            movement == Movement::TURN_RIGHT_90);
+
+  m_movement = movement;
+  // TODO: upforgrabs
+  // Setting these member variables should be unnecessary here
+  m_doomedToCrash = false;
+  m_halfStepsToMoveForward = 0;
+  // TODO: upforgrabs
+  // Half turns shouldn't count as full turn
+  m_stats->addTurn();
+}
+
+void SimulationEngine::setWall(int x, int y, QChar direction) {
+  if (m_view == nullptr || !isWithinMaze(x, y)) {
+    return;
+  }
+  if (!CHAR_TO_DIRECTION().contains(direction)) {
+    return;
+  }
+  Direction d = CHAR_TO_DIRECTION().value(direction);
+  m_view->getMazeGraphic()->setWall(x, y, d);
+  Wall opposingWall = getOpposingWall({x, y, d});
+  if (isWithinMaze(opposingWall.x, opposingWall.y)) {
+    m_view->getMazeGraphic()->setWall(opposingWall.x, opposingWall.y,
+                                      opposingWall.d);
+  }
+}
+
+void SimulationEngine::clearWall(int x, int y, QChar direction) {
+  if (m_view == nullptr || !isWithinMaze(x, y)) {
+    return;
+  }
+  if (!CHAR_TO_DIRECTION().contains(direction)) {
+    return;
+  }
+  Direction d = CHAR_TO_DIRECTION().value(direction);
+  m_view->getMazeGraphic()->clearWall(x, y, d);
+  Wall opposingWall = getOpposingWall({x, y, d});
+  if (isWithinMaze(opposingWall.x, opposingWall.y)) {
+    m_view->getMazeGraphic()->clearWall(opposingWall.x, opposingWall.y,
+                                        opposingWall.d);
+  }
+}
+
+void SimulationEngine::setColor(int x, int y, QChar color) {
+  if (m_view == nullptr || !isWithinMaze(x, y)) {
+    return;
+  }
+  if (!CHAR_TO_COLOR().contains(color)) {
+    return;
+  }
+  m_view->getMazeGraphic()->setColor(x, y, CHAR_TO_COLOR().value(color));
+  m_tilesWithColor.insert({x, y});
+}
+
+void SimulationEngine::clearColor(int x, int y) {
+  if (m_view == nullptr || !isWithinMaze(x, y)) {
+    return;
+  }
+  m_view->getMazeGraphic()->clearColor(x, y);
+  m_tilesWithColor -= {x, y};
+}
+
+void SimulationEngine::clearAllColor() {
+  for (QPair<int, int> position : m_tilesWithColor) {
+    m_view->getMazeGraphic()->clearColor(position.first, position.second);
+  }
+  m_tilesWithColor.clear();
+}
+
+void SimulationEngine::setText(int x, int y, QString text) {
+  if (m_view == nullptr || !isWithinMaze(x, y)) {
+    return;
+  }
+  // A set rather than a regex, since this runs for every cell of setTexts
+  static const QSet<QChar> supported = [] {
+    QSet<QChar> characters;
+    for (QChar c : FontImage::characters()) {
+      characters.insert(c);
+    }
+    return characters;
+  }();
+  for (QChar &c : text) {
+    if (!supported.contains(c)) {
+      c = '?';
+    }
+  }
+  m_view->getMazeGraphic()->setText(x, y, text);
+  m_tilesWithText.insert({x, y});
+}
+
+void SimulationEngine::clearText(int x, int y) {
+  if (m_view == nullptr || !isWithinMaze(x, y)) {
+    return;
+  }
+  m_view->getMazeGraphic()->clearText(x, y);
+  m_tilesWithText -= {x, y};
+}
+
+void SimulationEngine::clearAllText() {
+  for (QPair<int, int> position : m_tilesWithText) {
+    m_view->getMazeGraphic()->clearText(position.first, position.second);
+  }
+  m_tilesWithText.clear();
+}
+
+void SimulationEngine::setColors(int x, int y, int width, int height,
+                                 const QString &runs) {
+  if (m_view == nullptr || width < 1 || height < 1) {
+    return;
+  }
+  // Each run is an optional count followed by a color character, or by '.'
+  // to clear the color; expand them all before changing anything
+  QString colors;
+  int count = 0;
+  for (QChar c : runs) {
+    if (c.isDigit()) {
+      count = count * 10 + c.digitValue();
+      if (count > width * height) {
+        return;
+      }
+      continue;
+    }
+    if (c != '.' && !CHAR_TO_COLOR().contains(c)) {
+      return;
+    }
+    colors.append(QString(qMax(count, 1), c));
+    count = 0;
+  }
+  if (count != 0 || colors.size() > width * height) {
+    return;
+  }
+  for (int i = 0; i < colors.size(); i += 1) {
+    if (colors.at(i) == '.') {
+      clearColor(x + i % width, y + i / width);
+    } else {
+      setColor(x + i % width, y + i / width, colors.at(i));
+    }
+  }
+}
+
+void SimulationEngine::setTexts(int x, int y, int width, int height,
+                                const QString &texts) {
+  if (m_view == nullptr || width < 1 || height < 1) {
+    return;
+  }
+  // Texts are separated by '|', and an empty one clears the text
+  QStringList cells = texts.split('|');
+  if (cells.size() > width * height) {
+    return;
+  }
+  for (int i = 0; i < cells.size(); i += 1) {
+    if (cells.at(i).isEmpty()) {
+      clearText(x + i % width, y + i / width);
+    } else {
+      setText(x + i % width, y + i / width, cells.at(i));
+    }
+  }
+}
+
+void SimulationEngine::setWalls(const QString &hex) {
+  static const int NORTH = 1;
+  static const int EAST = 2;
+  static const int SOUTH = 4;
+  static const int WEST = 8;
+  // The value of each hex digit, or -1 for any other character
+  static const QVector<int> nibbles = [] {
+    QVector<int> values(128, -1);
+    for (int i = 0; i < 10; i += 1) {
+      values['0' + i] = i;
+    }
+    for (int i = 0; i < 6; i += 1) {
+      values['a' + i] = 10 + i;
+      values['A' + i] = 10 + i;
+    }
+    return values;
+  }();
+  if (m_view == nullptr) {
+    return;
+  }
+  // One hex digit per cell, with bits for north, east, south, and west
+  int width = m_maze->getWidth();
+  int height = m_maze->getHeight();
+  if (hex.size() != width * height) {
+    return;
+  }
+  QVector<int> cells(hex.size());
+  for (int i = 0; i < hex.size(); i += 1) {
+    ushort c = hex.at(i).unicode();
+    cells[i] = c < nibbles.size() ? nibbles.at(c) : -1;
+    if (cells.at(i) == -1) {
+      return;
+    }
+  }
+  // Each interior wall is described twice, and both have to agree
+  for (int i = 0; i < cells.size(); i += 1) {
+    if (i % width + 1 < width &&
+        bool(cells.at(i) & EAST) != bool(cells.at(i + 1) & WEST)) {
+      return;
+    }
+    if (i / width + 1 < height &&
+        bool(cells.at(i) & NORTH) != bool(cells.at(i + width) & SOUTH)) {
+      return;
+    }
+  }
+  // Then each wall only has to be written once
+  for (int i = 0; i < cells.size(); i += 1) {
+    int x = i % width;
+    int y = i / width;
+    setEdge(x, y, Direction::NORTH, cells.at(i) & NORTH);
+    setEdge(x, y, Direction::EAST, cells.at(i) & EAST);
+    if (y == 0) {
+      setEdge(x, y, Direction::SOUTH, cells.at(i) & SOUTH);
+    }
+    if (x == 0) {
+      setEdge(x, y, Direction::WEST, cells.at(i) & WEST);
+    }
+  }
+}
+
+bool SimulationEngine::wasReset() { return m_wasReset; }
+
+void SimulationEngine::ackReset() {
+  m_mouse->reset();
+  resetMovement();
+  m_wasReset = false;
+  m_stats->penalizeForReset();
+  m_stats->endUnfinishedRun();
+  emit resetAcknowledged();
+}
+
+bool SimulationEngine::isWall(SemiPosition semiPos,
+                              SemiDirection semiDir) const {
+  ASSERT_LE(0, semiPos.x);
+  ASSERT_LE(semiPos.x, m_maze->getWidth() * 2);
+  ASSERT_LE(0, semiPos.y);
+  ASSERT_LE(semiPos.y, m_maze->getHeight() * 2);
+
+  // Maze locations
+  auto mazeLocation = semiPos.toMazeLocation();
+  int mazeX = mazeLocation.first;
+  int mazeY = mazeLocation.second;
+
+  // Should never be inside a corner
+  if (semiPos.x % 2 == 0 && semiPos.y % 2 == 0) {
+    ASSERT_NEVER_RUNS();
+  }
+  // We're in the center of the cell
+  else if (semiPos.x % 2 == 1 && semiPos.y % 2 == 1) {
+    if (ORDINAL_DIRECTIONS().contains(semiDir)) {
+      // We're aiming at a corner
+      return true;
+    }
+    Direction d = SEMI_TO_CARDINAL().value(semiDir);
+    return m_maze->isWall(mazeX, mazeY, d);
+  }
+  // We're on the vertical edge of a cell
+  else if (semiPos.x % 2 == 0 && semiPos.y % 2 == 1) {
+    // Facing a corner post
+    if (semiDir == SemiDirection::NORTH || semiDir == SemiDirection::SOUTH) {
+      return true;
+    }
+    // Facing center of cell
+    else if (semiDir == SemiDirection::EAST || semiDir == SemiDirection::WEST) {
+      return false;
+    } else if (semiDir == SemiDirection::NORTHEAST) {
+      // On the edge of the maze, no walls outside
+      if (semiPos.x == m_maze->getWidth() * 2) {
+        return false;
+      }
+      return m_maze->isWall(mazeX, mazeY, Direction::NORTH);
+    } else if (semiDir == SemiDirection::SOUTHEAST) {
+      // On the edge of the maze, no walls outside
+      if (semiPos.x == m_maze->getWidth() * 2) {
+        return false;
+      }
+      return m_maze->isWall(mazeX, mazeY, Direction::SOUTH);
+    } else if (semiDir == SemiDirection::NORTHWEST) {
+      // On the edge of the maze, no walls outside
+      if (semiPos.x == 0) {
+        return false;
+      }
+      return m_maze->isWall(mazeX - 1, mazeY, Direction::NORTH);
+    } else if (semiDir == SemiDirection::SOUTHWEST) {
+      // On the edge of the maze, no walls outside
+      if (semiPos.x == 0) {
+        return false;
+      }
+      return m_maze->isWall(mazeX - 1, mazeY, Direction::SOUTH);
+    }
+  }
+  // We're on the horizontal edge of a cell
+  else if (semiPos.x % 2 == 1 && semiPos.y % 2 == 0) {
+    // Facing a corner post
+    if (semiDir == SemiDirection::EAST || semiDir == SemiDirection::WEST) {
+      return true;
+    }
+    // Facing center of cell
+    else if (semiDir == SemiDirection::NORTH ||
+             semiDir == SemiDirection::SOUTH) {
+      return false;
+    } else if (semiDir == SemiDirection::NORTHEAST) {
+      // On the edge of the maze, no walls outside
+      if (semiPos.y == m_maze->getHeight() * 2) {
+        return false;
+      }
+      return m_maze->isWall(mazeX, mazeY, Direction::EAST);
+    } else if (semiDir == SemiDirection::NORTHWEST) {
+      // On the edge of the maze, no walls outside
+      if (semiPos.y == m_maze->getHeight() * 2) {
+        return false;
+      }
+      return m_maze->isWall(mazeX, mazeY, Direction::WEST);
+    } else if (semiDir == SemiDirection::SOUTHEAST) {
+      // On the edge of the maze, no walls outside
+      if (semiPos.y == 0) {
+        return false;
+      }
+      return m_maze->isWall(mazeX, mazeY - 1, Direction::EAST);
+    } else if (semiDir == SemiDirection::SOUTHWEST) {
+      // On the edge of the maze, no walls outside
+      if (semiPos.y == 0) {
+        return false;
+      }
+      return m_maze->isWall(mazeX, mazeY - 1, Direction::WEST);
+    }
+  } else {
+    ASSERT_NEVER_RUNS();
+  }
+}
+
+bool SimulationEngine::isWall(SemiPosition semiPos, SemiDirection semiDir,
+                              int halfStepsAhead) const {
+  // Check all possible wall locations between the starting position and the
+  // ending position; if any, then there is a wall obstructing the path.
+  if (isWall(semiPos, semiDir)) {
+    return true;
+  }
+  for (int i = 1; i <= halfStepsAhead; i += 1) {
+    semiPos = getNextPosition(semiPos, semiDir);
+    if (isWall(semiPos, semiDir)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+SemiPosition SimulationEngine::getNextPosition(SemiPosition semiPos,
+                                               SemiDirection semiDir) const {
+  switch (semiDir) {
+    case SemiDirection::NORTH:
+      semiPos.y += 1;
+      break;
+    case SemiDirection::SOUTH:
+      semiPos.y -= 1;
+      break;
+    case SemiDirection::EAST:
+      semiPos.x += 1;
+      break;
+    case SemiDirection::WEST:
+      semiPos.x -= 1;
+      break;
+    case SemiDirection::NORTHEAST:
+      semiPos.x += 1;
+      semiPos.y += 1;
+      break;
+    case SemiDirection::NORTHWEST:
+      semiPos.x -= 1;
+      semiPos.y += 1;
+      break;
+    case SemiDirection::SOUTHEAST:
+      semiPos.x += 1;
+      semiPos.y -= 1;
+      break;
+    case SemiDirection::SOUTHWEST:
+      semiPos.x -= 1;
+      semiPos.y -= 1;
+      break;
+    default:
+      ASSERT_NEVER_RUNS();
+  }
+  return semiPos;
+}
+
+bool SimulationEngine::isWithinMaze(int x, int y) const {
+  return (0 <= x && x < m_maze->getWidth() && 0 <= y &&
+          y < m_maze->getHeight());
+}
+
+void SimulationEngine::setEdge(int x, int y, Direction direction, bool isWall) {
+  MazeGraphic *mazeGraphic = m_view->getMazeGraphic();
+  Wall opposingWall = getOpposingWall({x, y, direction});
+  bool hasOpposingWall = isWithinMaze(opposingWall.x, opposingWall.y);
+  if (isWall) {
+    mazeGraphic->setWall(x, y, direction);
+    if (hasOpposingWall) {
+      mazeGraphic->setWall(opposingWall.x, opposingWall.y, opposingWall.d);
+    }
+  } else {
+    mazeGraphic->clearWall(x, y, direction);
+    if (hasOpposingWall) {
+      mazeGraphic->clearWall(opposingWall.x, opposingWall.y, opposingWall.d);
+    }
+  }
+}
+
+Wall SimulationEngine::getOpposingWall(Wall wall) const {
+  switch (wall.d) {
+    case Direction::NORTH:
+      return {wall.x, wall.y + 1, Direction::SOUTH};
+    case Direction::EAST:
+      return {wall.x + 1, wall.y, Direction::WEST};
+    case Direction::SOUTH:
+      return {wall.x, wall.y - 1, Direction::NORTH};
+    case Direction::WEST:
+      return {wall.x - 1, wall.y, Direction::EAST};
+    default:
+      ASSERT_NEVER_RUNS();
+  }
+}
+
+Coordinate SimulationEngine::getCoordinate(SemiPosition semiPos) const {
+  QPair<int, int> mazeLocation = semiPos.toMazeLocation();
+  ASSERT_TR(isWithinMaze(mazeLocation.first, mazeLocation.second));
+  Coordinate coordinate = Coordinate::Cartesian(
+      Dimensions::halfTileLength() * static_cast<double>(semiPos.x),
+      Dimensions::halfTileLength() * static_cast<double>(semiPos.y));
+  return coordinate;
+}
+
+}  // namespace mms
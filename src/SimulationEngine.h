@@ -0,0 +1,323 @@
+#pragma once
+
+#include <QByteArray>
+#include <QChar>
+#include <QElapsedTimer>
+#include <QIODevice>
+#include <QObject>
+#include <QPair>
+#include <QQueue>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+#include "Command.h"
+#include "CommandLatency.h"
+#include "Maze.h"
+#include "MazeView.h"
+#include "Mouse.h"
+#include "RunTimeline.h"
+#include "RunTrace.h"
+#include "SharedMemoryTransport.h"
+#include "SimulationClock.h"
+#include "Stats.h"
+
+namespace mms {
+
+enum class Movement {
+  MOVE_STRAIGHT,
+  MOVE_DIAGONAL,
+  TURN_RIGHT_45,
+  TURN_RIGHT_90,
+  TURN_LEFT_45,
+  TURN_LEFT_90,
+  NONE,
+};
+
+struct Wall {
+  int x;
+  int y;
+  Direction d;
+};
+
+// Everything that the rest of a run depends on, at a point where every
+// command received so far has been answered (see SimulationEngine::isIdle)
+struct RunSnapshot {
+  Coordinate mouseTranslation;
+  Angle mouseRotation;
+  SemiPosition startingPosition;
+  SemiDirection startingDirection;
+  double robotSeconds;
+  Stats::State stats;
+  QVector<MazeGraphic::TileState> tiles;  // Empty without a view
+  QSet<QPair<int, int>> tilesWithColor;
+  QSet<QPair<int, int>> tilesWithText;
+  QByteArray inputBuffer;  // An incomplete command
+  bool wasReset;
+  bool resetSubscribed;
+  bool binaryInput;
+  bool binaryOutput;
+  bool sensing;
+  qint64 numCommands;
+  double commandCpuSeconds;
+  CommandLatency latency;
+  RunTimeline::State timeline;
+  qint64 runMicros;
+  CommandType lastAnswered;
+  qint64 lastAnsweredMicros;
+  bool isThinking;
+};
+
+// The SimulationEngine owns all of the state of a single algorithm run (the
+// mouse, its movement, the command queue, and the stats) and implements the
+// mouse API. It has no dependency on any widget, so it can be driven either by
+// the Window or by a headless runner.
+class SimulationEngine : public QObject {
+  Q_OBJECT
+
+ public:
+  SimulationEngine(QObject *parent = nullptr);
+  ~SimulationEngine();
+
+  // The maze must not change while a run is in progress
+  void setMaze(const Maze *maze);
+
+  // Creates a new mouse and starts accepting commands; responses are written
+  // to the given device. The view is optional - when it's null, commands that
+  // only affect the visualization are ignored. Replays pass the clock of the
+  // recording, and pass each command's recorded time to receiveCommands.
+  void startRun(QIODevice *device, MazeView *view,
+                const RecordedClock *recordedClock = nullptr);
+
+  // Whether future runs offer the algorithm a SharedMemoryTransport as well as
+  // stdin/stdout. Responses switch over once the algorithm sends a command
+  // through it. The name to pass to the algorithm is empty if not offered.
+  void setSharedMemoryEnabled(bool enabled);
+  QString getSharedMemoryName() const;
+
+  // Records commands, responses, and resets to the writer, if any, which
+  // must outlive the run
+  void setTraceWriter(TraceWriter *writer);
+
+  // Stops consuming commands, leaves the mouse where it is
+  void stopRun();
+
+  // Deletes the mouse and resets all movement state
+  void removeMouse();
+
+  const Mouse *getMouse() const;
+  Stats *getStats() const;
+  const SimulationClock *getClock() const;
+
+  // Robot seconds per wall-clock second; with infinity, each movement
+  // completes in a single step without waiting on any timer
+  void setRealTimeFactor(double realTimeFactor);
+
+  // Pause/reset; a reset is only pushed to the algorithm if it subscribed,
+  // otherwise it waits for wasReset
+  bool isPaused() const;
+  void setPaused(bool paused);
+  void requestReset();
+
+  // Feed output of the algorithm process into the engine
+  void receiveCommands(const QByteArray &bytes);
+  void receiveCommands(const QByteArray &bytes, qint64 arrivalMicros);
+
+  // Whether every command received so far has been answered
+  bool isIdle() const;
+
+  // Saves the run in progress, which must be idle, or puts it back the way
+  // it was; restoring drops any queued commands, but keeps the device, the
+  // view, and whether the run is paused
+  RunSnapshot saveSnapshot() const;
+  void restoreSnapshot(const RunSnapshot &snapshot);
+
+  // Number of commands received this run, and the CPU time spent on them
+  qint64 getNumCommands() const;
+  double getCommandCpuSeconds() const;
+
+  // Where the wall-clock time of this run went, per command type
+  const CommandLatency *getLatency() const;
+
+  // The movements of this run, and the algorithm's profiling markers, timed
+  // in wall-clock microseconds since the run started
+  const RunTimeline *getTimeline() const;
+  qint64 getRunMicros() const;
+
+ signals:
+  // Emitted once the algorithm acknowledges a reset
+  void resetAcknowledged();
+
+  // Emitted once the algorithm says that it's done with the maze, which
+  // only happens in server mode (see HeadlessRunner)
+  void runEnded();
+
+ private:
+  // ----- Run state -----
+
+  const Maze *m_maze;
+  Mouse *m_mouse;
+  MazeView *m_view;
+  Stats *m_stats;
+  QIODevice *m_device;
+
+  // ----- Pause/reset ----
+
+  bool m_isPaused;
+  bool m_wasReset;
+
+  // Whether a reset is pushed to the algorithm as soon as it's requested
+  bool m_resetSubscribed;
+
+  // ----- Communication -----
+
+  // Buffer to hold incomplete output, only
+  // process once a command is complete
+  QByteArray m_inputBuffer;
+
+  // Responses are encoded as they're produced and written all at once, after
+  // the whole batch of commands (or timer tick) that produced them
+  QByteArray m_outputBuffer;
+  bool m_isReceiving;
+
+  // Which protocol each direction uses; input switches as soon as the
+  // handshake is parsed, output once the handshake is answered
+  bool m_binaryInput;
+  bool m_binaryOutput;
+
+  // Whether movement acks carry the walls where the mouse ended up
+  bool m_sensing;
+
+  bool m_sharedMemoryEnabled;
+  SharedMemoryTransport *m_transport;
+
+  TraceWriter *m_traceWriter;
+  const RecordedClock *m_recordedClock;
+
+  QQueue<Command> m_commandQueue;
+  QTimer *m_commandQueueTimer;
+
+  qint64 m_numCommands;
+  double m_commandCpuSeconds;
+
+  // Commands answered by the responses in the output buffer, and the last
+  // one that was written, whose think time lasts until the next command
+  CommandLatency m_latency;
+  RunTimeline m_timeline;
+  QElapsedTimer m_runTimer;
+  qint64 m_runTimerOffsetMicros;  // Where the timer was restarted, see restore
+  QVector<QPair<CommandType, qint64>> m_answered;  // Type and arrival
+  CommandType m_lastAnswered;
+  qint64 m_lastAnsweredMicros;
+  bool m_isThinking;
+
+  // Progress through the motion script at the head of the queue
+  int m_motionIndex;
+  bool m_motionCrashed;
+
+  void dispatchCommand(const Command &command);
+  Response executeCommand(const Command &command);
+  void processQueuedCommands();
+  void respond(const Response &response);
+  void flushResponses();
+
+  // Records the response to the current motion of the script at the head of
+  // the queue, replacing it with the response to send (or INVALID for none),
+  // and returns whether the whole script is done
+  bool advanceMotionScript(Response *response);
+
+  // ----- Movement -----
+
+  static const double MAX_SLEEP_SECONDS;
+  static const double ROBOT_PROGRESS_PER_SECOND;
+
+  static const SemiPosition INITIAL_STARTING_POSITION;
+  static const SemiDirection INITIAL_STARTING_DIRECTION;
+
+  SemiPosition m_startingPosition;
+  SemiDirection m_startingDirection;
+  Movement m_movement;
+  bool m_doomedToCrash;  // if the requested movement will result in a crash
+  int m_corridorHalfSteps;  // the length of the moveUntil* in progress
+  int m_halfStepsToMoveForward;  // the number of allowable half-steps for the
+                                 // movement
+  double m_movementProgress;
+  double m_movementStepSize;
+  SimulationClock m_clock;
+
+  double progressRequired(Movement movement);
+  void updateMouseProgress(double progress);
+  void scheduleMouseProgressUpdate();
+  bool isMoving();
+  bool hasUnboundedSpeed() const;
+  void resetMovement();
+
+  // ----- API -----
+
+  int mazeWidth();
+  int mazeHeight();
+
+  // Is there a wall in front of the mouse N half-steps ahead of where it
+  // currently is? Zero means current position of the mouse.
+  bool wallFront(int halfStepsAhead);
+  bool wallRight(int halfStepsAhead);
+  bool wallLeft(int halfStepsAhead);
+  bool wallBack(int halfStepsAhead);
+  bool wallFrontRight(int halfStepsAhead);
+  bool wallFrontLeft(int halfStepsAhead);
+  bool wallBackRight(int halfStepsAhead);
+  bool wallBackLeft(int halfStepsAhead);
+
+  // All of the above in one bitmask: front, right, back, left, front-right,
+  // front-left, back-right, back-left, from the least significant bit up
+  int walls(int halfStepsAhead);
+
+  bool moveForward(int numHalfSteps);
+  void turn(Movement movement);
+
+  // The number of half-steps the mouse can move forward before it reaches a
+  // wall or, if a side is given (L, R, or A for either), an opening on that
+  // side. Zero if there's a wall directly in front of the mouse.
+  int corridorLength(QChar side);
+
+  void setWall(int x, int y, QChar direction);
+  void clearWall(int x, int y, QChar direction);
+
+  void setColor(int x, int y, QChar color);
+  void clearColor(int x, int y);
+  void clearAllColor();
+
+  void setText(int x, int y, QString text);
+  void clearText(int x, int y);
+  void clearAllText();
+
+  // Bulk forms of the above, which cover a rectangle of cells in row-major
+  // order starting from (x, y), or the whole maze for setWalls. A malformed
+  // payload changes nothing, and for setWalls that includes neighboring cells
+  // that disagree about the wall between them.
+  void setColors(int x, int y, int width, int height, const QString &runs);
+  void setTexts(int x, int y, int width, int height, const QString &texts);
+  void setWalls(const QString &hex);
+
+  bool wasReset();
+  void ackReset();
+
+  // ----- Helpers -----
+
+  QSet<QPair<int, int>> m_tilesWithColor;
+  QSet<QPair<int, int>> m_tilesWithText;
+
+  bool isWall(SemiPosition semiPos, SemiDirection semiDir) const;
+  bool isWall(SemiPosition semiPos, SemiDirection semiDir,
+              int halfStepsAhead) const;
+  SemiPosition getNextPosition(SemiPosition semiPos,
+                               SemiDirection semiDir) const;
+  bool isWithinMaze(int x, int y) const;
+  Wall getOpposingWall(Wall wall) const;
+  // Sets or clears a wall on both of its sides, assuming (x, y) is in the maze
+  void setEdge(int x, int y, Direction direction, bool isWall);
+  Coordinate getCoordinate(SemiPosition semiPos) const;
+};
+
+}  // namespace mms
@@ -4,7 +4,10 @@
 
 namespace mms {
 
-Stats::Stats() : startedRun(false), solved(false), penalty(0.0) {}
+const float Stats::UNSOLVED_SCORE = 2000;
+
+Stats::Stats(QObject *parent)
+    : QObject(parent), startedRun(false), solved(false), penalty(0.0) {}
 
 void Stats::reset(StatsEnum stat) {
   setStat(stat, 0);
@@ -14,21 +17,29 @@ void Stats::reset(StatsEnum stat) {
 void Stats::resetAll() {
   startedRun = false;
   solved = false;
-  QMapIterator<StatsEnum, QLineEdit *> i(textField);
-  while (i.hasNext()) {
-    i.next();
-    StatsEnum key = i.key();
+  for (StatsEnum key : {
+           StatsEnum::TOTAL_DISTANCE,
+           StatsEnum::TOTAL_TURNS,
+           StatsEnum::BEST_RUN_DISTANCE,
+           StatsEnum::BEST_RUN_TURNS,
+           StatsEnum::CURRENT_RUN_DISTANCE,
+           StatsEnum::CURRENT_RUN_TURNS,
+           StatsEnum::TOTAL_EFFECTIVE_DISTANCE,
+           StatsEnum::BEST_RUN_EFFECTIVE_DISTANCE,
+           StatsEnum::CURRENT_RUN_EFFECTIVE_DISTANCE,
+           StatsEnum::SCORE,
+       }) {
     // Set best run equal to max value as a placeholder
     // Display no value until a start-to-finish run is recorded
     if (key == StatsEnum::BEST_RUN_TURNS) {
       statValues[key] = std::numeric_limits<float>::max();
-      textField[key]->setText("");
+      setText(key, "");
     } else if (key == StatsEnum::BEST_RUN_DISTANCE) {
       statValues[key] = 0;
-      textField[key]->setText("");
+      setText(key, "");
     } else if (key == StatsEnum::BEST_RUN_EFFECTIVE_DISTANCE) {
       statValues[key] = 0;
-      textField[key]->setText("");
+      setText(key, "");
     } else if (key == StatsEnum::SCORE) {
       // Score is set in updateScore()
       continue;
@@ -65,11 +76,12 @@ void Stats::increment(StatsEnum stat, float increase) {
 
 void Stats::setStat(StatsEnum stat, float value) {
   statValues[stat] = value;
-  textField[stat]->setText(QString::number(statValues[stat]));
+  setText(stat, QString::number(statValues[stat]));
 }
 
-void Stats::bindText(StatsEnum stat, QLineEdit *uiText) {
-  textField[stat] = uiText;
+void Stats::setText(StatsEnum stat, const QString &text) {
+  statTexts[stat] = text;
+  emit statChanged(stat, text);
 }
 
 void Stats::updateScore() {
@@ -82,9 +94,9 @@ void Stats::updateScore() {
             0.1 * (statValues[StatsEnum::TOTAL_EFFECTIVE_DISTANCE] +
                    statValues[StatsEnum::TOTAL_TURNS]);
   } else {
-    score = 2000;  // default score
+    score = UNSOLVED_SCORE;
   }
-  textField[StatsEnum::SCORE]->setText(QString::number(score));
+  setText(StatsEnum::SCORE, QString::number(score));
 }
 
 float Stats::getEffectiveDistance(int distance) {
@@ -128,6 +140,22 @@ void Stats::endUnfinishedRun() {
 
 void Stats::penalizeForReset() { penalty = 15; }
 
+bool Stats::isSolved() const { return solved; }
+
+Stats::State Stats::getState() const {
+  return {statValues, statTexts, startedRun, solved, penalty};
+}
+
+void Stats::setState(const State &state) {
+  statValues = state.statValues;
+  startedRun = state.startedRun;
+  solved = state.solved;
+  penalty = state.penalty;
+  for (auto it = state.statTexts.begin(); it != state.statTexts.end(); ++it) {
+    setText(it.key(), it.value());
+  }
+}
+
 bool Stats::isInteger(StatsEnum stat) {
   // Returns true if the stat represents an integer value
   return (stat == StatsEnum::TOTAL_DISTANCE || stat == StatsEnum::TOTAL_TURNS ||
@@ -138,7 +166,7 @@ bool Stats::isInteger(StatsEnum stat) {
 }
 
 QString Stats::getStat(StatsEnum stat) {
-  QString statText = textField[stat]->text();
+  QString statText = statTexts.value(stat);
   // Cast the stat to an integer if it's supposed to be an integer
   if (isInteger(stat)) {
     bool converted;
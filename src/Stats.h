@@ -1,7 +1,8 @@
 #pragma once
 
-#include <QLineEdit>
 #include <QMap>
+#include <QObject>
+#include <QString>
 
 namespace mms {
 
@@ -18,16 +19,24 @@ enum class StatsEnum {
   SCORE  // has a text box but is not saved in an array
 };
 
-class Stats {
+class Stats : public QObject {
+  Q_OBJECT
+
  public:
-  Stats();
+  // Everything the stats depend on, so they can be saved and restored
+  struct State {
+    QMap<StatsEnum, float> statValues;
+    QMap<StatsEnum, QString> statTexts;
+    bool startedRun;
+    bool solved;
+    float penalty;
+  };
+
+  Stats(QObject *parent = nullptr);
   void resetAll();  // Reset all score stats
   void addDistance(
       int distance);  // Increase the distance and effective distance
   void addTurn();     // Increment the number of turns
-  void bindText(
-      StatsEnum stat,
-      QLineEdit *uiText);  // Indicate which QLineEdit to use for that stat
   void startRun();   // A run starts when the mouse exits the starting tile.
   void finishRun();  // A run finishes when the mouse enters the goal.
   void endUnfinishedRun();  // A run ends unfinished when the mouse returns to
@@ -36,16 +45,26 @@ class Stats {
                             // start tile
   QString getStat(
       StatsEnum stat);  // Return the current value of the requested stat
+  bool isSolved() const;  // Whether a start-to-finish run was recorded
+  State getState() const;
+  void setState(const State &state);  // Emits statChanged for every stat
+
+  static const float UNSOLVED_SCORE;  // The score until the maze is solved
+
+ signals:
+  // Emitted whenever the displayed text of a stat changes
+  void statChanged(StatsEnum stat, const QString &text);
 
  private:
   QMap<StatsEnum, float> statValues;
-  QMap<StatsEnum, QLineEdit *> textField;
+  QMap<StatsEnum, QString> statTexts;
   bool startedRun;
   bool solved;
   float penalty;
   void updateScore();
   void increment(StatsEnum stat, float increase);
   void setStat(StatsEnum stat, float value);
+  void setText(StatsEnum stat, const QString &text);
   static float getEffectiveDistance(int distance);
   void reset(StatsEnum stat);
   bool isInteger(StatsEnum stat);
@@ -0,0 +1,322 @@
+#include "TextProtocol.h"
+
+#include <iterator>
+
+#include "Color.h"
+#include "Direction.h"
+#include "NameTable.h"
+#include "Stats.h"
+
+namespace mms {
+
+Command TextProtocol::parse(QByteArrayView line) {
+  static constexpr NameEntry<StatsEnum> STAT_NAMES[] = {
+      {"total-distance", StatsEnum::TOTAL_DISTANCE},
+      {"total-turns", StatsEnum::TOTAL_TURNS},
+      {"best-run-distance", StatsEnum::BEST_RUN_DISTANCE},
+      {"best-run-turns", StatsEnum::BEST_RUN_TURNS},
+      {"current-run-distance", StatsEnum::CURRENT_RUN_DISTANCE},
+      {"current-run-turns", StatsEnum::CURRENT_RUN_TURNS},
+      {"total-effective-distance", StatsEnum::TOTAL_EFFECTIVE_DISTANCE},
+      {"best-run-effective-distance", StatsEnum::BEST_RUN_EFFECTIVE_DISTANCE},
+      {"current-run-effective-distance",
+       StatsEnum::CURRENT_RUN_EFFECTIVE_DISTANCE},
+      {"score", StatsEnum::SCORE},
+  };
+  static constexpr NameTable<CommandType, std::size(COMMAND_NAMES)>
+      commandTypes(COMMAND_NAMES);
+  static constexpr NameTable<StatsEnum, std::size(STAT_NAMES)> statTypes(
+      STAT_NAMES);
+  static_assert(commandTypes.isPerfect(), "No perfect hash for command names");
+  static_assert(statTypes.isPerfect(), "No perfect hash for stat names");
+
+  Command command;
+  Command invalid;
+
+  // Windows compatibility
+  if (!line.isEmpty() && line.at(line.size() - 1) == '\r') {
+    line = line.chopped(1);
+  }
+  int offset = 0;
+  if (!commandTypes.lookup(nextToken(line, &offset), &command.type)) {
+    return invalid;
+  }
+
+  // Special parsing to allow space characters in the text
+  if (command.type == CommandType::SET_TEXT ||
+      command.type == CommandType::SET_TEXTS) {
+    bool ok = true;
+    auto nextInt = [&]() {
+      bool intOk = false;
+      int value = parseInt(nextToken(line, &offset), &intOk);
+      ok = ok && intOk;
+      return value;
+    };
+    command.x = nextInt();
+    command.y = nextInt();
+    if (command.type == CommandType::SET_TEXTS) {
+      command.width = nextInt();
+      command.height = nextInt();
+    }
+    if (!ok || offset >= line.size()) {
+      return invalid;
+    }
+    command.text = QString::fromUtf8(line.sliced(offset + 1));
+    return command;
+  }
+
+  // Labels are the rest of the line, and may contain spaces
+  if (command.type == CommandType::MARK ||
+      command.type == CommandType::SPAN_BEGIN) {
+    if (command.type == CommandType::SPAN_BEGIN) {
+      QByteArrayView edge = nextToken(line, &offset);
+      if (edge == "end") {
+        command.type = CommandType::SPAN_END;
+      } else if (edge != "begin") {
+        return invalid;
+      }
+    }
+    while (offset < line.size() && line.at(offset) == ' ') {
+      offset += 1;
+    }
+    if (offset == line.size()) {
+      return invalid;
+    }
+    command.text = QString::fromUtf8(line.sliced(offset));
+    return command;
+  }
+
+  // Scripts have any number of arguments
+  if (command.type == CommandType::MOVES ||
+      command.type == CommandType::MOVES_SUMMARY) {
+    for (QByteArrayView token = nextToken(line, &offset); !token.isEmpty();
+         token = nextToken(line, &offset)) {
+      Motion motion;
+      if (!parseMotion(token, &motion)) {
+        return invalid;
+      }
+      command.motions.append(motion);
+    }
+    return command.motions.isEmpty() ? invalid : command;
+  }
+
+  // Everything else has at most five arguments
+  QByteArrayView args[6];
+  int numArgs = 0;
+  while (numArgs < 6) {
+    args[numArgs] = nextToken(line, &offset);
+    if (args[numArgs].isEmpty()) {
+      break;
+    }
+    numArgs += 1;
+  }
+
+  // Parses the coordinates of visualization commands
+  auto parseCell = [&]() {
+    bool xOk = false;
+    bool yOk = false;
+    command.x = parseInt(args[0], &xOk);
+    command.y = parseInt(args[1], &yOk);
+    return xOk && yOk;
+  };
+
+  switch (command.type) {
+    case CommandType::SET_WALL:
+    case CommandType::CLEAR_WALL:
+      if (numArgs != 3 || !parseCell() || args[2].size() != 1 ||
+          !CHAR_TO_DIRECTION().contains(QChar::fromLatin1(args[2].at(0)))) {
+        return invalid;
+      }
+      command.c = QChar::fromLatin1(args[2].at(0));
+      return command;
+    case CommandType::SET_COLOR:
+      if (numArgs != 3 || !parseCell() || args[2].size() != 1 ||
+          !CHAR_TO_COLOR().contains(QChar::fromLatin1(args[2].at(0)))) {
+        return invalid;
+      }
+      command.c = QChar::fromLatin1(args[2].at(0));
+      return command;
+    case CommandType::CLEAR_COLOR:
+    case CommandType::CLEAR_TEXT:
+      if (numArgs != 2 || !parseCell()) {
+        return invalid;
+      }
+      return command;
+    case CommandType::SET_COLORS: {
+      bool widthOk = false;
+      bool heightOk = false;
+      if (numArgs != 5 || !parseCell()) {
+        return invalid;
+      }
+      command.width = parseInt(args[2], &widthOk);
+      command.height = parseInt(args[3], &heightOk);
+      if (!widthOk || !heightOk) {
+        return invalid;
+      }
+      command.text = QString::fromLatin1(args[4]);
+      return command;
+    }
+    case CommandType::SET_WALLS:
+      if (numArgs != 1) {
+        return invalid;
+      }
+      command.text = QString::fromLatin1(args[0]);
+      return command;
+    case CommandType::MOVE_UNTIL_OPENING:
+      // Either side by default
+      if (numArgs > 1) {
+        return invalid;
+      }
+      if (numArgs == 0 || args[0] == "any") {
+        command.c = 'A';
+      } else if (args[0] == "L" || args[0] == "R") {
+        command.c = QChar::fromLatin1(args[0].at(0));
+      } else {
+        return invalid;
+      }
+      return command;
+    case CommandType::SUBSCRIBE:
+      // Reset is the only event so far
+      if (numArgs != 1 || args[0] != "reset") {
+        return invalid;
+      }
+      return command;
+    case CommandType::GET_STAT: {
+      StatsEnum stat;
+      if (numArgs != 1 || !statTypes.lookup(args[0], &stat)) {
+        return invalid;
+      }
+      command.n = static_cast<int>(stat);
+      return command;
+    }
+    case CommandType::WALL_FRONT:
+    case CommandType::WALL_BACK:
+    case CommandType::WALL_LEFT:
+    case CommandType::WALL_RIGHT:
+    case CommandType::WALL_FRONT_RIGHT:
+    case CommandType::WALL_FRONT_LEFT:
+    case CommandType::WALL_BACK_RIGHT:
+    case CommandType::WALL_BACK_LEFT:
+    case CommandType::WALLS:
+    case CommandType::MOVE_FORWARD:
+    case CommandType::MOVE_FORWARD_HALF:
+      // A malformed argument reads as zero (and moving zero steps crashes)
+      if (numArgs > 1) {
+        return invalid;
+      }
+      if (numArgs == 1) {
+        command.n = parseInt(args[0], nullptr);
+      }
+      return command;
+    default:
+      // Everything else takes no arguments
+      if (numArgs != 0) {
+        return invalid;
+      }
+      return command;
+  }
+}
+
+QByteArrayView TextProtocol::nextToken(QByteArrayView line, int *offset) {
+  int begin = *offset;
+  while (begin < line.size() && line.at(begin) == ' ') {
+    begin += 1;
+  }
+  int end = begin;
+  while (end < line.size() && line.at(end) != ' ') {
+    end += 1;
+  }
+  *offset = end;
+  return line.sliced(begin, end - begin);
+}
+
+int TextProtocol::parseInt(QByteArrayView token, bool *ok) {
+  // Zero and not ok for anything but an optional sign and up to nine digits
+  int i = 0;
+  bool negative = false;
+  if (!token.isEmpty() && (token.at(0) == '-' || token.at(0) == '+')) {
+    negative = token.at(0) == '-';
+    i += 1;
+  }
+  int value = 0;
+  bool valid = i < token.size() && token.size() - i <= 9;
+  for (; valid && i < token.size(); i += 1) {
+    char c = token.at(i);
+    valid = '0' <= c && c <= '9';
+    value = value * 10 + (c - '0');
+  }
+  if (ok != nullptr) {
+    *ok = valid;
+  }
+  if (!valid) {
+    return 0;
+  }
+  return negative ? -value : value;
+}
+
+bool TextProtocol::parseMotion(QByteArrayView token, Motion *motion) {
+  static constexpr NameEntry<CommandType> TURN_NAMES[] = {
+      {"R", CommandType::TURN_RIGHT_90},   {"R90", CommandType::TURN_RIGHT_90},
+      {"L", CommandType::TURN_LEFT_90},    {"L90", CommandType::TURN_LEFT_90},
+      {"R45", CommandType::TURN_RIGHT_45}, {"L45", CommandType::TURN_LEFT_45},
+  };
+  static constexpr NameTable<CommandType, std::size(TURN_NAMES)> turns(
+      TURN_NAMES);
+  static_assert(turns.isPerfect(), "No perfect hash for turn names");
+  if (turns.lookup(token, &motion->type)) {
+    return true;
+  }
+
+  // Straight moves in full steps, diagonal moves in half steps,
+  // with an optional distance that defaults to one
+  if (token.at(0) == 'F') {
+    motion->type = CommandType::MOVE_FORWARD;
+  } else if (token.at(0) == 'D' || token.at(0) == 'H') {
+    motion->type = CommandType::MOVE_FORWARD_HALF;
+  } else {
+    return false;
+  }
+  if (token.size() > 1) {
+    bool ok = false;
+    motion->n = parseInt(token.sliced(1), &ok);
+    return ok;
+  }
+  return true;
+}
+
+QByteArrayView TextProtocol::commandName(CommandType type) {
+  // The first name is the canonical one, e.g., turnRight over turnRight90
+  for (const NameEntry<CommandType> &entry : COMMAND_NAMES) {
+    if (entry.value == type) {
+      return QByteArrayView(entry.name);
+    }
+  }
+  return QByteArrayView("invalid");
+}
+
+QByteArray TextProtocol::encode(const Response &response) {
+  switch (response.type) {
+    case ResponseType::ACK:
+      return "ack\n";
+    case ResponseType::ACK_WALLS:
+      return QByteArray("ack ") + QByteArray::number(response.value) + "\n";
+    case ResponseType::CRASH:
+      return "crash\n";
+    case ResponseType::BOOLEAN:
+      return response.value ? "true\n" : "false\n";
+    case ResponseType::INTEGER:
+    case ResponseType::WALLS:
+      return QByteArray::number(response.value) + "\n";
+    case ResponseType::STAT:
+      // Cannot return an empty string, -1 indicates an empty field
+      return (response.text.isEmpty() ? QString("-1") : response.text)
+                 .toUtf8() +
+             "\n";
+    case ResponseType::EVENT:
+      return QByteArray("event ") + response.text.toUtf8() + "\n";
+    default:
+      return QByteArray();
+  }
+}
+
+}  // namespace mms
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+
+#include "Command.h"
+#include "NameTable.h"
+
+namespace mms {
+
+// The default protocol: one command per line, space-separated arguments, and
+// one response per line
+class TextProtocol {
+ public:
+  // The TextProtocol class is not constructible
+  TextProtocol() = delete;
+
+  // Parses a single line (without the newline) in place; malformed or
+  // unknown commands have type INVALID
+  static Command parse(QByteArrayView line);
+
+  // Returns the response line, including the newline, or nothing
+  // for responses that aren't sent
+  static QByteArray encode(const Response &response);
+
+  // The name of a command type, as parsed
+  static QByteArrayView commandName(CommandType type);
+
+  // Every command name, including aliases, which parse looks up through a
+  // NameTable built from this at compile time
+  static constexpr NameEntry<CommandType> COMMAND_NAMES[] = {
+      {"mazeWidth", CommandType::MAZE_WIDTH},
+      {"mazeHeight", CommandType::MAZE_HEIGHT},
+      {"wallFront", CommandType::WALL_FRONT},
+      {"wallBack", CommandType::WALL_BACK},
+      {"wallLeft", CommandType::WALL_LEFT},
+      {"wallRight", CommandType::WALL_RIGHT},
+      {"wallFrontRight", CommandType::WALL_FRONT_RIGHT},
+      {"wallFrontLeft", CommandType::WALL_FRONT_LEFT},
+      {"wallBackRight", CommandType::WALL_BACK_RIGHT},
+      {"wallBackLeft", CommandType::WALL_BACK_LEFT},
+      {"walls", CommandType::WALLS},
+      {"moveForward", CommandType::MOVE_FORWARD},
+      {"moveForwardHalf", CommandType::MOVE_FORWARD_HALF},
+      {"turnRight", CommandType::TURN_RIGHT_90},
+      {"turnRight90", CommandType::TURN_RIGHT_90},
+      {"turnLeft", CommandType::TURN_LEFT_90},
+      {"turnLeft90", CommandType::TURN_LEFT_90},
+      {"turnRight45", CommandType::TURN_RIGHT_45},
+      {"turnLeft45", CommandType::TURN_LEFT_45},
+      {"moves", CommandType::MOVES},
+      {"movesSummary", CommandType::MOVES_SUMMARY},
+      {"moveUntilWall", CommandType::MOVE_UNTIL_WALL},
+      {"moveUntilOpening", CommandType::MOVE_UNTIL_OPENING},
+      {"setWall", CommandType::SET_WALL},
+      {"clearWall", CommandType::CLEAR_WALL},
+      {"setColor", CommandType::SET_COLOR},
+      {"clearColor", CommandType::CLEAR_COLOR},
+      {"clearAllColor", CommandType::CLEAR_ALL_COLOR},
+      {"setText", CommandType::SET_TEXT},
+      {"clearText", CommandType::CLEAR_TEXT},
+      {"clearAllText", CommandType::CLEAR_ALL_TEXT},
+      {"setColors", CommandType::SET_COLORS},
+      {"setTexts", CommandType::SET_TEXTS},
+      {"setWalls", CommandType::SET_WALLS},
+      {"wasReset", CommandType::WAS_RESET},
+      {"ackReset", CommandType::ACK_RESET},
+      {"subscribe", CommandType::SUBSCRIBE},
+      {"getStat", CommandType::GET_STAT},
+      {"mark", CommandType::MARK},
+      {"span", CommandType::SPAN_BEGIN},
+      {"endRun", CommandType::END_RUN},
+      {"useSensing", CommandType::USE_SENSING},
+      {"useBinaryProtocol", CommandType::USE_BINARY_PROTOCOL},
+  };
+
+ private:
+  // Returns the next space-separated token at or after the offset, which is
+  // moved past it, or an empty token at the end of the line
+  static QByteArrayView nextToken(QByteArrayView line, int *offset);
+
+  // Parses a decimal integer, zero if it's malformed
+  static int parseInt(QByteArrayView token, bool *ok);
+
+  // Parses one step of a motion script, such as "F3", "R", or "L45"
+  static bool parseMotion(QByteArrayView token, Motion *motion);
+};
+
+}  // namespace mms
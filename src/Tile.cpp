@@ -7,19 +7,12 @@ namespace mms {
 
 Tile::Tile() { ASSERT_NEVER_RUNS(); }
 
-Tile::Tile(int x, int y, int distance, QMap<Direction, bool> walls)
-    : m_x(x), m_y(y), m_distance(distance), m_walls(walls) {}
+Tile::Tile(int x, int y) : m_x(x), m_y(y) {}
 
 int Tile::getX() const { return m_x; }
 
 int Tile::getY() const { return m_y; }
 
-int Tile::getDistance() const { return m_distance; }
-
-bool Tile::isWall(Direction direction) const {
-  return m_walls.value(direction);
-}
-
 Polygon Tile::getFullPolygon() const { return m_fullPolygon; }
 
 Polygon Tile::getWallPolygon(Direction direction) const {
@@ -8,15 +8,14 @@
 
 namespace mms {
 
+// The geometry of a cell, for drawing it; the walls are kept by the Maze
 class Tile {
  public:
   Tile();
-  Tile(int x, int y, int distance, QMap<Direction, bool> walls);
+  Tile(int x, int y);
 
   int getX() const;
   int getY() const;
-  int getDistance() const;
-  bool isWall(Direction direction) const;
 
   Polygon getFullPolygon() const;
   Polygon getWallPolygon(Direction direction) const;
@@ -27,8 +26,6 @@ class Tile {
  private:
   int m_x;
   int m_y;
-  int m_distance;
-  QMap<Direction, bool> m_walls;
 
   Polygon m_fullPolygon;
   Polygon m_interiorPolygon;
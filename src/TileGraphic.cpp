@@ -6,14 +6,17 @@
 #include "Color.h"
 #include "ColorManager.h"
 #include "FontImage.h"
+#include "Tile.h"
 
 namespace mms {
 
 TileGraphic::TileGraphic() { ASSERT_NEVER_RUNS(); }
 
-TileGraphic::TileGraphic(const Tile *tile, BufferInterface *bufferInterface,
-                         bool isTruthView)
-    : m_tile(tile),
+TileGraphic::TileGraphic(const Maze *maze, int x, int y,
+                         BufferInterface *bufferInterface, bool isTruthView)
+    : m_maze(maze),
+      m_x(x),
+      m_y(y),
       m_bufferInterface(bufferInterface),
       m_color(ColorManager::get()->getTileBaseColor()),
       m_colorWasSet(false),
@@ -30,6 +33,10 @@ void TileGraphic::clearWall(Direction direction) {
 }
 
 void TileGraphic::setColor(Color color) {
+  // Bulk commands tend to repaint cells with their current color
+  if (m_colorWasSet && m_color == color) {
+    return;
+  }
   m_color = color;
   m_colorWasSet = true;
   updateColor();
@@ -42,6 +49,11 @@ void TileGraphic::clearColor() {
 }
 
 void TileGraphic::setText(const QString &text) {
+  // Laying out text is expensive, and most cells keep theirs from one
+  // repaint of the grid to the next
+  if (text == m_text) {
+    return;
+  }
   m_text = text;
   updateText();
 }
@@ -51,24 +63,38 @@ void TileGraphic::clearText() {
   updateText();
 }
 
+bool TileGraphic::isWall(Direction direction) const {
+  return m_walls.value(direction, false);
+}
+
+bool TileGraphic::isColorSet() const { return m_colorWasSet; }
+
+Color TileGraphic::getColor() const { return m_color; }
+
+QString TileGraphic::getText() const { return m_text; }
+
 void TileGraphic::drawPolygons() const {
   // Note that the order in which we call insertIntoGraphicCpuBuffer
   // determines the order in which the polygons are drawn. Also note that the
   // *StartingIndex methods in GrahicsUtilities.h depend upon this order.
 
+  // The geometry is only needed here, so it isn't kept around
+  Tile tile(m_x, m_y);
+  tile.initPolygons(m_maze->getWidth(), m_maze->getHeight());
+
   // Draw the base of the tile
-  m_bufferInterface->insertIntoGraphicCpuBuffer(m_tile->getFullPolygon(),
-                                                m_color, 255);
+  m_bufferInterface->insertIntoGraphicCpuBuffer(tile.getFullPolygon(), m_color,
+                                                255);
 
   // Draw each of the walls of the tile
   for (Direction direction : CARDINAL_DIRECTIONS()) {
     m_bufferInterface->insertIntoGraphicCpuBuffer(
-        m_tile->getWallPolygon(direction), getWallColor(direction),
+        tile.getWallPolygon(direction), getWallColor(direction),
         getWallAlpha(direction));
   }
 
   // Draw the corners of the tile
-  for (Polygon polygon : m_tile->getCornerPolygons()) {
+  for (Polygon polygon : tile.getCornerPolygons()) {
     m_bufferInterface->insertIntoGraphicCpuBuffer(
         polygon, ColorManager::get()->getTileCornerColor(), 255);
   }
@@ -96,14 +122,14 @@ void TileGraphic::refreshColors() {
 
 void TileGraphic::updateWall(Direction direction) const {
   m_bufferInterface->updateTileGraphicWallColor(
-      m_tile->getX(), m_tile->getY(), direction, getWallColor(direction),
+      m_x, m_y, direction, getWallColor(direction),
       getWallAlpha(direction));
 }
 
 void TileGraphic::updateColor() const {
   Color default_ = ColorManager::get()->getTileBaseColor();
   Color color = m_colorWasSet ? m_color : default_;
-  m_bufferInterface->updateTileGraphicBaseColor(m_tile->getX(), m_tile->getY(),
+  m_bufferInterface->updateTileGraphicBaseColor(m_x, m_y,
                                                 color);
 }
 
@@ -138,7 +164,7 @@ void TileGraphic::updateText() const {
         c = rowsOfText.at(row).at(col);
       }
       ASSERT_TR(FontImage::positions().contains(c));
-      m_bufferInterface->updateTileGraphicText(m_tile->getX(), m_tile->getY(),
+      m_bufferInterface->updateTileGraphicText(m_x, m_y,
                                                numRows, numCols, row, col, c);
     }
   }
@@ -160,7 +186,7 @@ unsigned char TileGraphic::getWallAlpha(Direction direction) const {
   if (m_walls.value(direction)) {
     return 255;
   }
-  if (m_tile->isWall(direction)) {
+  if (m_maze->isWall(m_x, m_y, direction)) {
     if (m_isTruthView) {
       return 255;
     } else {
@@ -5,14 +5,15 @@
 
 #include "BufferInterface.h"
 #include "Color.h"
-#include "Tile.h"
+#include "Direction.h"
+#include "Maze.h"
 
 namespace mms {
 
 class TileGraphic {
  public:
   TileGraphic();
-  TileGraphic(const Tile *tile, BufferInterface *bufferInterface,
+  TileGraphic(const Maze *maze, int x, int y, BufferInterface *bufferInterface,
               bool isTruthView);
 
   void setWall(Direction direction);
@@ -24,6 +25,11 @@ class TileGraphic {
   void setText(const QString &text);
   void clearText();
 
+  bool isWall(Direction direction) const;
+  bool isColorSet() const;
+  Color getColor() const;
+  QString getText() const;
+
   // TODO: upforgrabs
   // Rename these to "reload" or something
   void drawPolygons() const;
@@ -33,7 +39,9 @@ class TileGraphic {
 
  private:
   // Input and output objects
-  const Tile *m_tile;
+  const Maze *m_maze;
+  int m_x;
+  int m_y;
   BufferInterface *m_bufferInterface;
 
   // Visual state
@@ -0,0 +1,79 @@
+#include "TimelineWidget.h"
+
+#include <QColor>
+#include <QPainter>
+#include <QRect>
+
+namespace mms {
+
+const double TimelineWidget::WINDOW_SECONDS = 10.0;
+const int TimelineWidget::LANE_HEIGHT = 20;
+const int TimelineWidget::MAX_SPAN_LANES = 6;
+
+TimelineWidget::TimelineWidget(QWidget *parent)
+    : QWidget(parent), m_timeline(nullptr), m_nowMicros(0) {
+  setMinimumHeight(LANE_HEIGHT * (2 + MAX_SPAN_LANES));
+}
+
+void TimelineWidget::refresh(const RunTimeline *timeline, qint64 nowMicros) {
+  m_timeline = timeline;
+  m_nowMicros = nowMicros;
+  update();
+}
+
+void TimelineWidget::paintEvent(QPaintEvent *event) {
+  Q_UNUSED(event);
+  QPainter painter(this);
+  painter.fillRect(rect(), QColor(32, 32, 32));
+  if (m_timeline == nullptr) {
+    return;
+  }
+
+  qint64 windowMicros = static_cast<qint64>(WINDOW_SECONDS * 1e6);
+  qint64 beginMicros = m_nowMicros - windowMicros;
+  auto toX = [&](qint64 micros) {
+    return static_cast<int>((micros - beginMicros) * width() / windowMicros);
+  };
+  auto drawBar = [&](const TimelineEvent &event, int lane, QColor color) {
+    qint64 endMicros = event.endMicros < 0 ? m_nowMicros : event.endMicros;
+    QRect bar(toX(event.beginMicros), lane * LANE_HEIGHT + 2,
+              qMax(1, toX(endMicros) - toX(event.beginMicros)),
+              LANE_HEIGHT - 4);
+    painter.fillRect(bar, color);
+    painter.setPen(QColor(240, 240, 240));
+    painter.drawText(bar, Qt::AlignLeft | Qt::AlignVCenter, event.label);
+  };
+
+  // Lanes, from the top
+  painter.setPen(QColor(128, 128, 128));
+  painter.drawText(QRect(4, 0, width(), LANE_HEIGHT),
+                   Qt::AlignLeft | Qt::AlignVCenter, "movements");
+  painter.drawText(QRect(4, LANE_HEIGHT, width(), LANE_HEIGHT),
+                   Qt::AlignLeft | Qt::AlignVCenter, "marks");
+
+  // Events end in order, so the ones in the window are all at the back
+  const QVector<TimelineEvent> &events = m_timeline->getEvents();
+  for (int i = events.size() - 1; i >= 0; i -= 1) {
+    const TimelineEvent &event = events.at(i);
+    if (event.endMicros < beginMicros) {
+      break;
+    }
+    if (event.kind == TimelineKind::MOVEMENT) {
+      drawBar(event, 0, QColor(48, 96, 160));
+    } else {
+      int x = toX(event.beginMicros);
+      painter.setPen(QColor(230, 140, 40));
+      painter.drawLine(x, LANE_HEIGHT, x, height());
+      painter.drawText(QRect(x + 2, LANE_HEIGHT, width(), LANE_HEIGHT),
+                       Qt::AlignLeft | Qt::AlignVCenter, event.label);
+    }
+  }
+  for (const TimelineEvent &span : m_timeline->getSpans()) {
+    bool isVisible = span.endMicros < 0 || span.endMicros >= beginMicros;
+    if (isVisible && span.depth < MAX_SPAN_LANES) {
+      drawBar(span, 2 + span.depth, QColor(56, 140, 80));
+    }
+  }
+}
+
+}  // namespace mms
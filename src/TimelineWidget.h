@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QPaintEvent>
+#include <QWidget>
+
+#include "RunTimeline.h"
+
+namespace mms {
+
+// Draws the last WINDOW_SECONDS of a RunTimeline: the simulator's movements in
+// the top lane, the algorithm's marks in the next one, and its spans below
+// those, one lane per level of nesting
+class TimelineWidget : public QWidget {
+  Q_OBJECT
+
+ public:
+  TimelineWidget(QWidget *parent = nullptr);
+
+  // Redraws the window that ends at the given time; the timeline must stay
+  // alive until the next refresh
+  void refresh(const RunTimeline *timeline, qint64 nowMicros);
+
+ protected:
+  void paintEvent(QPaintEvent *event) override;
+
+ private:
+  static const double WINDOW_SECONDS;
+  static const int LANE_HEIGHT;
+  static const int MAX_SPAN_LANES;
+
+  const RunTimeline *m_timeline;
+  qint64 m_nowMicros;
+};
+
+}  // namespace mms
@@ -0,0 +1,201 @@
+#include "TracePlayer.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "AssertMacros.h"
+
+namespace mms {
+
+const int TracePlayer::KEYFRAME_INTERVAL = 1000;
+
+ReplaySink::ReplaySink(const QVector<TraceRecord> &records, QObject *parent)
+    : QIODevice(parent),
+      m_numBytesWritten(0),
+      m_responseEnds(QVector<qint64>()),
+      m_responseMicros(QVector<qint64>()) {
+  qint64 numResponseBytes = 0;
+  for (const TraceRecord &record : records) {
+    if (record.kind == TraceKind::RESPONSES) {
+      numResponseBytes += record.bytes.size();
+      m_responseEnds.append(numResponseBytes);
+      m_responseMicros.append(record.micros);
+    }
+  }
+  open(QIODevice::WriteOnly | QIODevice::Unbuffered);
+}
+
+qint64 ReplaySink::getNumBytesWritten() const { return m_numBytesWritten; }
+
+void ReplaySink::setNumBytesWritten(qint64 numBytesWritten) {
+  m_numBytesWritten = numBytesWritten;
+}
+
+qint64 ReplaySink::getResponseMicros() const {
+  // Bytes past the end of the recording, if the replay diverged, go with the
+  // last response
+  if (m_responseEnds.isEmpty()) {
+    return 0;
+  }
+  qsizetype index =
+      std::lower_bound(m_responseEnds.begin(), m_responseEnds.end(),
+                       m_numBytesWritten) -
+      m_responseEnds.begin();
+  return m_responseMicros.at(qMin(index, m_responseMicros.size() - 1));
+}
+
+qint64 ReplaySink::readData(char *data, qint64 maxSize) {
+  Q_UNUSED(data);
+  Q_UNUSED(maxSize);
+  return -1;
+}
+
+qint64 ReplaySink::writeData(const char *data, qint64 maxSize) {
+  Q_UNUSED(data);
+  m_numBytesWritten += maxSize;
+  emit bytesWritten(maxSize);
+  return maxSize;
+}
+
+TracePlayer::TracePlayer(SimulationEngine *engine,
+                         const QVector<TraceRecord> &records, QObject *parent)
+    : QObject(parent),
+      m_engine(engine),
+      m_records(records),
+      m_sink(new ReplaySink(records, this)),
+      m_nextRecord(0),
+      m_numResponseBytes(0),
+      m_numDivergences(0),
+      m_isFinished(false),
+      m_isSeekable(false),
+      m_keyframes(QVector<Keyframe>()) {
+  // Queued, since responses are written in the middle of processing commands
+  connect(m_sink, &QIODevice::bytesWritten, this, &TracePlayer::step,
+          Qt::QueuedConnection);
+}
+
+void TracePlayer::start(MazeView *view, bool seekable) {
+  m_engine->startRun(m_sink, view, m_sink);
+  m_engine->getStats()->resetAll();
+  m_isSeekable = seekable;
+  if (m_isSeekable) {
+    buildKeyframes();
+  }
+  step();
+}
+
+int TracePlayer::getNumDivergences() const { return m_numDivergences; }
+
+qint64 TracePlayer::getDurationMicros() const {
+  return m_records.isEmpty() ? 0 : m_records.last().micros;
+}
+
+qint64 TracePlayer::getPositionMicros() const {
+  return m_nextRecord == 0 ? 0 : m_records.at(m_nextRecord - 1).micros;
+}
+
+void TracePlayer::seek(qint64 micros) {
+  ASSERT_TR(m_isSeekable);
+
+  // Every record up to and including the given time, starting from the last
+  // keyframe that comes before all of them
+  int endRecord =
+      std::upper_bound(m_records.begin(), m_records.end(), micros,
+                       [](qint64 micros, const TraceRecord &record) {
+                         return micros < record.micros;
+                       }) -
+      m_records.begin();
+  auto keyframe =
+      std::upper_bound(m_keyframes.begin(), m_keyframes.end(), endRecord,
+                       [](int record, const Keyframe &keyframe) {
+                         return record < keyframe.nextRecord;
+                       }) -
+      1;
+  restore(*keyframe);
+
+  // Catch up in one go, even if paused
+  bool isPaused = m_engine->isPaused();
+  double realTimeFactor = m_engine->getClock()->getRealTimeFactor();
+  m_engine->setPaused(false);
+  m_engine->setRealTimeFactor(std::numeric_limits<double>::infinity());
+  m_sink->blockSignals(true);
+  advance(endRecord);
+  m_sink->blockSignals(false);
+  m_engine->setRealTimeFactor(realTimeFactor);
+  m_engine->setPaused(isPaused);
+
+  m_isFinished = false;
+  step();
+}
+
+void TracePlayer::step() {
+  advance(m_records.size());
+  if (m_nextRecord == m_records.size() && !m_isFinished &&
+      m_engine->isIdle()) {
+    m_isFinished = true;
+    emit finished();
+  }
+}
+
+void TracePlayer::advance(int endRecord) {
+  while (m_nextRecord < endRecord) {
+    const TraceRecord &record = m_records.at(m_nextRecord);
+    if (record.kind == TraceKind::RESPONSES) {
+      m_numResponseBytes += record.bytes.size();
+      m_nextRecord += 1;
+      continue;
+    }
+    // Wait for the responses that the algorithm had seen, unless they
+    // can't come anymore because the engine has nothing left to do
+    if (m_sink->getNumBytesWritten() < m_numResponseBytes) {
+      if (!m_engine->isIdle()) {
+        return;
+      }
+      m_numDivergences += 1;
+      m_numResponseBytes = m_sink->getNumBytesWritten();
+    }
+    // Only between commands, never partway through one
+    if (m_isSeekable && m_engine->isIdle() &&
+        m_nextRecord >= m_keyframes.last().nextRecord + KEYFRAME_INTERVAL) {
+      m_keyframes.append({m_nextRecord, m_numResponseBytes,
+                          m_sink->getNumBytesWritten(), m_numDivergences,
+                          m_engine->saveSnapshot()});
+    }
+    m_nextRecord += 1;
+    if (record.kind == TraceKind::COMMANDS) {
+      m_engine->receiveCommands(record.bytes, record.micros);
+    } else {
+      m_engine->requestReset();
+    }
+  }
+}
+
+void TracePlayer::restore(const Keyframe &keyframe) {
+  m_engine->restoreSnapshot(keyframe.snapshot);
+  m_nextRecord = keyframe.nextRecord;
+  m_numResponseBytes = keyframe.numResponseBytes;
+  m_sink->setNumBytesWritten(keyframe.numBytesWritten);
+  m_numDivergences = keyframe.numDivergences;
+}
+
+void TracePlayer::buildKeyframes() {
+  // Nothing outside of the player should see this pass, which goes all the
+  // way through even if paused
+  bool isPaused = m_engine->isPaused();
+  double realTimeFactor = m_engine->getClock()->getRealTimeFactor();
+  m_engine->setPaused(false);
+  m_engine->setRealTimeFactor(std::numeric_limits<double>::infinity());
+  m_engine->blockSignals(true);
+  m_engine->getStats()->blockSignals(true);
+  m_sink->blockSignals(true);
+  m_keyframes.append({0, 0, 0, 0, m_engine->saveSnapshot()});
+  advance(m_records.size());
+  m_sink->blockSignals(false);
+  m_engine->getStats()->blockSignals(false);
+  m_engine->blockSignals(false);
+  m_engine->setRealTimeFactor(realTimeFactor);
+  m_engine->setPaused(isPaused);
+  restore(m_keyframes.first());
+}
+
+}  // namespace mms
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <QIODevice>
+#include <QObject>
+#include <QVector>
+
+#include "MazeView.h"
+#include "RunTrace.h"
+#include "SimulationEngine.h"
+
+namespace mms {
+
+// Stands in for the algorithm's stdin during a replay, only counting bytes,
+// and tells when the bytes written so far were sent in the recording
+class ReplaySink : public QIODevice, public RecordedClock {
+ public:
+  ReplaySink(const QVector<TraceRecord> &records, QObject *parent = nullptr);
+  qint64 getNumBytesWritten() const;
+  void setNumBytesWritten(qint64 numBytesWritten);
+  qint64 getResponseMicros() const override;
+
+ protected:
+  qint64 readData(char *data, qint64 maxSize) override;
+  qint64 writeData(const char *data, qint64 maxSize) override;
+
+ private:
+  qint64 m_numBytesWritten;
+
+  // The number of response bytes up to and including each response record,
+  // and the time of that record
+  QVector<qint64> m_responseEnds;
+  QVector<qint64> m_responseMicros;
+};
+
+// Replays a RunTrace through a SimulationEngine without starting the
+// algorithm, so the mouse, the view, and the stats end up exactly as they did
+// in the recorded run. Commands are fed to the engine as soon as it has sent
+// every response that the algorithm had read before sending them, which keeps
+// resets in the same place; how fast movements go is up to the engine.
+//
+// A seekable player first runs through the whole trace at unbounded speed,
+// saving a keyframe (see RunSnapshot) every so often. Seeking then restores
+// the last keyframe before the target and only replays the records after it.
+class TracePlayer : public QObject {
+  Q_OBJECT
+
+ public:
+  TracePlayer(SimulationEngine *engine, const QVector<TraceRecord> &records,
+              QObject *parent = nullptr);
+
+  // Starts a run on the engine, which must already have the trace's maze
+  void start(MazeView *view, bool seekable);
+
+  // The recorded time of the whole trace, and of the last record replayed
+  qint64 getDurationMicros() const;
+  qint64 getPositionMicros() const;
+
+  // Jumps to the given recorded time and continues from there; only for
+  // seekable players
+  void seek(qint64 micros);
+
+  // The number of times the engine didn't send the recorded responses, e.g.,
+  // because the trace came from a different version of the simulator
+  int getNumDivergences() const;
+
+ signals:
+  // Emitted once every record has been replayed and the engine is idle; the
+  // run is still in progress, so that the caller can inspect it (or seek)
+  void finished();
+
+ private:
+  // The number of records between keyframes, which bounds the work per seek
+  static const int KEYFRAME_INTERVAL;
+
+  struct Keyframe {
+    int nextRecord;
+    qint64 numResponseBytes;
+    qint64 numBytesWritten;
+    int numDivergences;
+    RunSnapshot snapshot;
+  };
+
+  SimulationEngine *m_engine;
+  QVector<TraceRecord> m_records;
+  ReplaySink *m_sink;
+  int m_nextRecord;
+  qint64 m_numResponseBytes;  // Recorded before the next record
+  int m_numDivergences;
+  bool m_isFinished;
+  bool m_isSeekable;
+  QVector<Keyframe> m_keyframes;
+
+  void step();
+
+  // Replays records until the given one, or until waiting on the engine
+  void advance(int endRecord);
+  void restore(const Keyframe &keyframe);
+
+  // Replays the whole trace at once, with the engine's signals blocked
+  void buildKeyframes();
+};
+
+}  // namespace mms
@@ -1,45 +1,31 @@
 #pragma once
 
-#include <QChar>
+#include <QCheckBox>
 #include <QCloseEvent>
 #include <QComboBox>
 #include <QGridLayout>
 #include <QLabel>
 #include <QMainWindow>
-#include <QPair>
 #include <QPlainTextEdit>
 #include <QProcess>
 #include <QPushButton>
-#include <QQueue>
-#include <QSet>
+#include <QSlider>
 #include <QTimer>
 #include <QToolButton>
 
+#include "LineSplitter.h"
+#include "LogSink.h"
 #include "Map.h"
 #include "Maze.h"
 #include "MazeView.h"
-#include "Mouse.h"
 #include "MouseGraphic.h"
+#include "SimulationEngine.h"
 #include "Stats.h"
+#include "TimelineWidget.h"
+#include "TracePlayer.h"
 
 namespace mms {
 
-enum class Movement {
-  MOVE_STRAIGHT,
-  MOVE_DIAGONAL,
-  TURN_RIGHT_45,
-  TURN_RIGHT_90,
-  TURN_LEFT_45,
-  TURN_LEFT_90,
-  NONE,
-};
-
-struct Wall {
-  int x;
-  int y;
-  Direction d;
-};
-
 class Window : public QMainWindow {
   Q_OBJECT
 
@@ -48,6 +34,9 @@ class Window : public QMainWindow {
   void closeEvent(QCloseEvent *event);
   void resizeEvent(QResizeEvent *event);
 
+  // Loads the maze of a recorded run and replays it, see RunTrace
+  void startReplay(const QString &tracePath);
+
  private:
   // ----- Graphics -----
 
@@ -93,6 +82,8 @@ class Window : public QMainWindow {
   QTabWidget *m_mouseAlgoOutputTabWidget;
   QPlainTextEdit *m_buildOutput;
   QPlainTextEdit *m_runOutput;
+  LogSink *m_buildLog;
+  LogSink *m_runLog;
 
   void cancelProcess(QProcess *process, QLabel *status);
   void cancelAllProcesses();
@@ -103,6 +94,11 @@ class Window : public QMainWindow {
   QProcess *m_buildProcess;
   QLabel *m_buildStatus;
 
+  // Split the build's stdout and stderr into lines, one per channel so that
+  // their partial lines don't get mixed up
+  LineSplitter m_buildOutputSplitter;
+  LineSplitter m_buildErrorSplitter;
+
   void startBuild();
   void cancelBuild();
   void onBuildExit(int exitCode, QProcess::ExitStatus exitStatus);
@@ -117,120 +113,63 @@ class Window : public QMainWindow {
   void cancelRun();
   void onRunExit(int exitCode, QProcess::ExitStatus exitStatus);
 
-  Mouse *m_mouse;
+  SimulationEngine *m_engine;
   MazeView *m_view;
   MouseGraphic *m_mouseGraphic;
 
   void removeMouseFromMaze();
 
+  // ----- Replay -----
+
+  TracePlayer *m_tracePlayer;
+  QSlider *m_replaySlider;  // In milliseconds of recorded time
+
+  void stopReplay();
+  void onReplayFinished();
+  void onReplaySliderChanged(int value);
+  void updateReplaySlider();
+
   // ----- Pause/reset ----
 
-  bool m_isPaused;
-  bool m_wasReset;
   QPushButton *m_pauseButton;
   QPushButton *m_resetButton;
 
   void onPauseButtonPressed();
   void onResetButtonPressed();
+  void onResetAcknowledged();
 
   // ----- Communication -----
 
-  static const QString ACK;
-  static const QString CRASH;
-  static const QString INVALID;
-
-  // Buffers to hold incomplete output, only
-  // process once terminated with a newline
-  QStringList m_logBuffer;
-  QStringList m_commandBuffer;
-  QStringList processText(QString text, QStringList *buffer);
-
-  QQueue<QString> m_commandQueue;
-  QTimer *m_commandQueueTimer;
-
-  void dispatchCommand(QString command);
-  QString executeCommand(QString command);
-  void processQueuedCommands();
+  // Splits the algorithm's stderr into lines
+  LineSplitter m_logSplitter;
 
   // ----- Movement -----
 
   static const int SPEED_SLIDER_MAX;
   static const int SPEED_SLIDER_DEFAULT;
-  static const double MIN_PROGRESS_PER_SECOND;
-  static const double MAX_PROGRESS_PER_SECOND;
-  static const double MAX_SLEEP_SECONDS;
-
-  // TODO: upforgrabs
-  // Encapsulate this state in the mouse class
-
-  static const SemiPosition INITIAL_STARTING_POSITION;
-  static const SemiDirection INITIAL_STARTING_DIRECTION;
-
-  SemiPosition m_startingPosition;
-  SemiDirection m_startingDirection;
-  Movement m_movement;
-  bool m_doomedToCrash;  // if the requested movement will result in a crash
-  int m_halfStepsToMoveForward;  // the number of allowable half-steps for the
-                                 // movement
-  double m_movementProgress;
-  double m_movementStepSize;
+  static const double MIN_REAL_TIME_FACTOR;
+  static const double MAX_REAL_TIME_FACTOR;
+
   QSlider *m_speedSlider;
+  QCheckBox *m_maxSpeedCheckBox;
 
-  double progressRequired(Movement movement);
-  void updateMouseProgress(double progress);
-  void scheduleMouseProgressUpdate();
-  bool isMoving();
+  void onSpeedSliderChanged(int value);
+  void onMaxSpeedCheckBoxToggled(bool checked);
 
   // ----- Scoreboard -----
   Stats *stats;
   void createStat(QString name, enum StatsEnum stat, int labelRow, int labelCol,
                   int valueRow, int valueCol, QGridLayout *layout);
 
-  // ----- API -----
-
-  int mazeWidth();
-  int mazeHeight();
-
-  // Is there a wall in front of the mouse N half-steps ahead of where it
-  // currently is? Zero means current position of the mouse.
-  bool wallFront(int halfStepsAhead);
-  bool wallRight(int halfStepsAhead);
-  bool wallLeft(int halfStepsAhead);
-  bool wallBack(int halfStepsAhead);
-  bool wallFrontRight(int halfStepsAhead);
-  bool wallFrontLeft(int halfStepsAhead);
-  bool wallBackRight(int halfStepsAhead);
-  bool wallBackLeft(int halfStepsAhead);
-
-  bool moveForward(int numHalfSteps);
-  void turn(Movement movement);
-
-  void setWall(int x, int y, QChar direction);
-  void clearWall(int x, int y, QChar direction);
-
-  void setColor(int x, int y, QChar color);
-  void clearColor(int x, int y);
-  void clearAllColor();
-
-  void setText(int x, int y, QString text);
-  void clearText(int x, int y);
-  void clearAllText();
-
-  bool wasReset();
-  void ackReset();
-
-  // ----- Helpers -----
+  // Per-command service and think times, see CommandLatency
+  QPlainTextEdit *m_latencyOutput;
+  void updateLatencyOutput();
+  void onLatencyExportButtonPressed();
 
-  QSet<QPair<int, int>> m_tilesWithColor;
-  QSet<QPair<int, int>> m_tilesWithText;
+  // ----- Timeline -----
 
-  QString boolToString(bool value) const;
-  bool isWall(SemiPosition semiPos, SemiDirection semiDir) const;
-  bool isWall(SemiPosition semiPos, SemiDirection semiDir,
-              int halfStepsAhead) const;
-  bool isWithinMaze(int x, int y) const;
-  Wall getOpposingWall(Wall wall) const;
-  Coordinate getCoordinate(SemiPosition semiPos) const;
+  TimelineWidget *m_timelineWidget;
+  void onTimelineExportButtonPressed();
 };
 
 }  // namespace mms
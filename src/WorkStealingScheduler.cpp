@@ -0,0 +1,94 @@
+#include "WorkStealingScheduler.h"
+
+#include <algorithm>
+
+#include "AssertMacros.h"
+
+namespace mms {
+
+WorkStealingScheduler::WorkStealingScheduler(int numWorkers)
+    : m_deques(numWorkers),
+      m_costs(),
+      m_queuedCosts(numWorkers, 0.0),
+      m_numStolen(0) {
+  ASSERT_LT(0, numWorkers);
+}
+
+void WorkStealingScheduler::addJobs(const QVector<double> &costs) {
+  ASSERT_TR(m_costs.isEmpty());
+  m_costs = costs;
+
+  // Most expensive first
+  QVector<int> order;
+  for (int i = 0; i < costs.size(); i += 1) {
+    order.append(i);
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [&](int a, int b) { return costs.at(a) > costs.at(b); });
+
+  // Greedily give each job to the worker with the least total cost so far;
+  // since jobs arrive in descending order, each deque stays sorted too
+  for (int job : order) {
+    int worker =
+        std::min_element(m_queuedCosts.begin(), m_queuedCosts.end()) -
+        m_queuedCosts.begin();
+    m_deques[worker].append(job);
+    m_queuedCosts[worker] += costs.at(job);
+  }
+}
+
+int WorkStealingScheduler::next(int worker) {
+  ASSERT_LE(0, worker);
+  ASSERT_LT(worker, m_deques.size());
+
+  // Own work first
+  if (!m_deques.at(worker).isEmpty()) {
+    return take(worker, false);
+  }
+
+  // Otherwise steal the cheapest job of the worker with the most cost left,
+  // not the most jobs: one huge maze outweighs many tiny ones. That worker's
+  // upcoming (expensive) jobs stay where they are.
+  int victim = -1;
+  for (int i = 0; i < m_deques.size(); i += 1) {
+    if (m_deques.at(i).isEmpty()) {
+      continue;
+    }
+    if (victim == -1 || m_queuedCosts.at(victim) < m_queuedCosts.at(i)) {
+      victim = i;
+    }
+  }
+  if (victim == -1) {
+    return -1;
+  }
+  m_numStolen += 1;
+  return take(victim, true);
+}
+
+int WorkStealingScheduler::numWorkers() const {
+  return m_deques.size();
+}
+
+int WorkStealingScheduler::numRemaining() const {
+  int count = 0;
+  for (const QList<int> &deque : m_deques) {
+    count += deque.size();
+  }
+  return count;
+}
+
+int WorkStealingScheduler::numStolen() const {
+  return m_numStolen;
+}
+
+int WorkStealingScheduler::take(int worker, bool fromBack) {
+  int job = fromBack ? m_deques[worker].takeLast()
+                     : m_deques[worker].takeFirst();
+  // Exactly zero once empty, rather than whatever rounding left behind
+  m_queuedCosts[worker] = m_deques.at(worker).isEmpty()
+                              ? 0.0
+                              : m_queuedCosts.at(worker) - m_costs.at(job);
+  return job;
+}
+
+}  // namespace mms
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QList>
+#include <QVector>
+
+namespace mms {
+
+// Hands out jobs (identified by index) to a fixed number of workers. Each
+// worker owns a deque of jobs, dealt out up front so that every worker gets a
+// similar total cost. A worker takes jobs from the front of its own deque and,
+// once that is empty, steals from the back of the other deque with the most
+// estimated cost left, so that no worker sits idle while there are jobs left
+// anywhere, and the longest tail is the one that gets shortened.
+class WorkStealingScheduler {
+ public:
+  WorkStealingScheduler(int numWorkers);
+
+  // The cost of each job is only an estimate, used to start the most
+  // expensive jobs first, to balance the initial distribution, and to pick
+  // whom to steal from. Jobs can only be added once.
+  void addJobs(const QVector<double> &costs);
+
+  // Returns the next job for the worker, or -1 if there are none left
+  int next(int worker);
+
+  int numWorkers() const;
+  int numRemaining() const;
+  int numStolen() const;
+
+ private:
+  QVector<QList<int>> m_deques;
+  QVector<double> m_costs;
+
+  // The total estimated cost of each deque
+  QVector<double> m_queuedCosts;
+
+  int m_numStolen;
+
+  int take(int worker, bool fromBack);
+};
+
+}  // namespace mms
@@ -16,6 +16,9 @@ SOURCES += $$files(*.cpp, true)
 HEADERS += $$files(*.h, true)
 RESOURCES = resources.qrc
 
+# shm_open, for SharedMemoryTransport, on older glibc
+linux: LIBS += -lrt
+
 DESTDIR     = ../bin
 MOC_DIR     = ../build/moc
 OBJECTS_DIR = ../build/obj
@@ -0,0 +1,43 @@
+#include <QCoreApplication>
+#include <QTest>
+
+#include "ColorManager.h"
+#include "Settings.h"
+#include "TestBinaryProtocol.h"
+#include "TestLineSplitter.h"
+#include "TestMaze.h"
+#include "TestMazeGraphic.h"
+#include "TestRunTimeline.h"
+#include "TestSimulationEngine.h"
+#include "TestTextProtocol.h"
+#include "TestTracePlayer.h"
+#include "TestWorkStealingScheduler.h"
+
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+
+  // Maze views need these, as in the simulator's main
+  mms::Settings::init();
+  mms::ColorManager::init();
+
+  int failures = 0;
+  mms::TestBinaryProtocol testBinaryProtocol;
+  failures += QTest::qExec(&testBinaryProtocol, argc, argv);
+  mms::TestLineSplitter testLineSplitter;
+  failures += QTest::qExec(&testLineSplitter, argc, argv);
+  mms::TestMaze testMaze;
+  failures += QTest::qExec(&testMaze, argc, argv);
+  mms::TestMazeGraphic testMazeGraphic;
+  failures += QTest::qExec(&testMazeGraphic, argc, argv);
+  mms::TestRunTimeline testRunTimeline;
+  failures += QTest::qExec(&testRunTimeline, argc, argv);
+  mms::TestSimulationEngine testSimulationEngine;
+  failures += QTest::qExec(&testSimulationEngine, argc, argv);
+  mms::TestTextProtocol testTextProtocol;
+  failures += QTest::qExec(&testTextProtocol, argc, argv);
+  mms::TestTracePlayer testTracePlayer;
+  failures += QTest::qExec(&testTracePlayer, argc, argv);
+  mms::TestWorkStealingScheduler testWorkStealingScheduler;
+  failures += QTest::qExec(&testWorkStealingScheduler, argc, argv);
+  return failures == 0 ? 0 : 1;
+}
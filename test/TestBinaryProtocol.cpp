@@ -0,0 +1,78 @@
+#include "TestBinaryProtocol.h"
+
+#include <QByteArray>
+#include <QTest>
+
+#include "BinaryProtocol.h"
+#include "Command.h"
+
+namespace mms {
+
+void TestBinaryProtocol::decodesMovesScript() {
+  // moves: moveForward 2, turnRight
+  const char bytes[] = {0x26, 0x02, 0x20, 0x02, 0x00, 0x22};
+  Command command;
+  QCOMPARE(BinaryProtocol::decode(bytes, sizeof(bytes), &command),
+           static_cast<int>(sizeof(bytes)));
+  QVERIFY(command.type == CommandType::MOVES);
+  QCOMPARE(static_cast<int>(command.motions.size()), 2);
+  QVERIFY(command.motions.at(0).type == CommandType::MOVE_FORWARD);
+  QCOMPARE(command.motions.at(0).n, 2);
+  QVERIFY(command.motions.at(1).type == CommandType::TURN_RIGHT_90);
+}
+
+void TestBinaryProtocol::endsMalformedMovesScript() {
+  // moves: turnRight, wallFront 1, turnLeft
+  const char bytes[] = {0x26, 0x03, 0x22, 0x10, 0x01, 0x00, 0x23};
+  Command command;
+  int consumed = BinaryProtocol::decode(bytes, sizeof(bytes), &command);
+  QCOMPARE(consumed, 3);
+  QVERIFY(command.type == CommandType::INVALID);
+
+  // The wall query is next
+  QCOMPARE(BinaryProtocol::decode(bytes + consumed, sizeof(bytes) - consumed,
+                                  &command),
+           3);
+  QVERIFY(command.type == CommandType::WALL_FRONT);
+  QCOMPARE(command.n, 1);
+
+  // An incomplete script waits for the rest of it, like any other command
+  QCOMPARE(BinaryProtocol::decode(bytes, 2, &command), 0);
+}
+
+void TestBinaryProtocol::rejectsNestedMovesScript() {
+  // Each script's count promises more motions than the data holds, which
+  // would wait for more data if the nested scripts were decoded
+  QByteArray bytes;
+  for (int i = 0; i < 100000; i += 1) {
+    bytes.append("\x26\xFF", 2);
+  }
+  Command command;
+  QCOMPARE(BinaryProtocol::decode(bytes.constData(), bytes.size(), &command),
+           2);
+  QVERIFY(command.type == CommandType::INVALID);
+
+  const char summary[] = {0x27, 0x02, 0x22, 0x26, 0x01, 0x22};
+  QCOMPARE(BinaryProtocol::decode(summary, sizeof(summary), &command), 3);
+  QVERIFY(command.type == CommandType::INVALID);
+}
+
+void TestBinaryProtocol::waitsForMovesScriptSplitAcrossReads() {
+  // movesSummary: turnLeft45, moveForwardHalf 3, moveForward 1
+  const char bytes[] = {0x27, 0x03, 0x25, 0x21, 0x03, 0x00, 0x20, 0x01, 0x00};
+  Command command;
+  for (int size = 0; size < static_cast<int>(sizeof(bytes)); size += 1) {
+    QCOMPARE(BinaryProtocol::decode(bytes, size, &command), 0);
+  }
+  QCOMPARE(BinaryProtocol::decode(bytes, sizeof(bytes), &command),
+           static_cast<int>(sizeof(bytes)));
+  QVERIFY(command.type == CommandType::MOVES_SUMMARY);
+  QCOMPARE(static_cast<int>(command.motions.size()), 3);
+  QVERIFY(command.motions.at(0).type == CommandType::TURN_LEFT_45);
+  QVERIFY(command.motions.at(1).type == CommandType::MOVE_FORWARD_HALF);
+  QCOMPARE(command.motions.at(1).n, 3);
+  QVERIFY(command.motions.at(2).type == CommandType::MOVE_FORWARD);
+  QCOMPARE(command.motions.at(2).n, 1);
+}
+
+}  // namespace mms
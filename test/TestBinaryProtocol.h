@@ -0,0 +1,25 @@
+#pragma once
+
+#include <QObject>
+
+namespace mms {
+
+class TestBinaryProtocol : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void decodesMovesScript();
+
+  // Something other than a movement ends a script, which is then invalid,
+  // and is decoded as a command of its own
+  void endsMalformedMovesScript();
+
+  // A script in a script is rejected without decoding it, however many of
+  // them there are
+  void rejectsNestedMovesScript();
+
+  // Only the whole script decodes, whichever read completes it
+  void waitsForMovesScriptSplitAcrossReads();
+};
+
+}  // namespace mms
@@ -0,0 +1,79 @@
+#include "TestLineSplitter.h"
+
+#include <QTest>
+
+#include "LineSplitter.h"
+
+namespace mms {
+
+void TestLineSplitter::splitsLinesWithinChunk() {
+  LineSplitter splitter;
+  QCOMPARE(toList(splitter.split("a\nbc\r\n\nd")),
+           QList<QByteArray>({"a", "bc", ""}));
+  QCOMPARE(toList(splitter.split("\n")), QList<QByteArray>({"d"}));
+}
+
+void TestLineSplitter::joinsLineSpanningChunks() {
+  LineSplitter splitter;
+  QVERIFY(splitter.split("ab").isEmpty());
+  QVERIFY(splitter.split("cd").isEmpty());
+  QCOMPARE(toList(splitter.split("ef\ng\nh")),
+           QList<QByteArray>({"abcdef", "g"}));
+  QCOMPARE(toList(splitter.split("\n")), QList<QByteArray>({"h"}));
+}
+
+void TestLineSplitter::dropsCarriageReturnBeforeNextChunk() {
+  LineSplitter splitter;
+  QVERIFY(splitter.split("x\r").isEmpty());
+  QCOMPARE(toList(splitter.split("\ny\r\n")), QList<QByteArray>({"x", "y"}));
+
+  // Even when the '\r' is all that's pending
+  QVERIFY(splitter.split("\r").isEmpty());
+  QCOMPARE(toList(splitter.split("\n")), QList<QByteArray>({""}));
+}
+
+void TestLineSplitter::ignoresEmptyChunk() {
+  LineSplitter splitter;
+  QVERIFY(splitter.split("").isEmpty());
+  QVERIFY(splitter.split("ab").isEmpty());
+  QVERIFY(splitter.split("").isEmpty());
+  QCOMPARE(toList(splitter.split("c\n")), QList<QByteArray>({"abc"}));
+}
+
+void TestLineSplitter::keepsChunkWithoutNewline() {
+  LineSplitter splitter;
+  QVERIFY(splitter.split("partial").isEmpty());
+  QCOMPARE(toList(splitter.split(" line\n")),
+           QList<QByteArray>({"partial line"}));
+
+  // Until it's dropped
+  QVERIFY(splitter.split("dropped").isEmpty());
+  splitter.clear();
+  QCOMPARE(toList(splitter.split("kept\n")), QList<QByteArray>({"kept"}));
+}
+
+void TestLineSplitter::keepsViewsUntilNextCall() {
+  LineSplitter splitter;
+  QByteArray first("one");
+  splitter.split(first);
+  QByteArray second("two\nthree\n");
+  const QVector<QByteArrayView> &lines = splitter.split(second);
+
+  // Only the second line points into the chunk
+  QCOMPARE(toList(lines), QList<QByteArray>({"onetwo", "three"}));
+  QVERIFY(lines.at(1).data() == second.constData() + 4);
+  first.fill('x');
+  QCOMPARE(lines.at(0).toByteArray(), QByteArray("onetwo"));
+  QCOMPARE(lines.at(1).toByteArray(), QByteArray("three"));
+}
+
+QList<QByteArray> TestLineSplitter::toList(
+    const QVector<QByteArrayView> &lines) {
+  QList<QByteArray> list;
+  for (QByteArrayView line : lines) {
+    list.append(line.toByteArray());
+  }
+  return list;
+}
+
+}  // namespace mms
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QList>
+#include <QObject>
+#include <QVector>
+
+namespace mms {
+
+class TestLineSplitter : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void splitsLinesWithinChunk();
+  void joinsLineSpanningChunks();
+
+  // "\r\n" split across two chunks is still one newline
+  void dropsCarriageReturnBeforeNextChunk();
+
+  void ignoresEmptyChunk();
+  void keepsChunkWithoutNewline();
+
+  // A joined line lives in the splitter, so it outlives its chunks
+  void keepsViewsUntilNextCall();
+
+ private:
+  static QList<QByteArray> toList(const QVector<QByteArrayView> &lines);
+};
+
+}  // namespace mms
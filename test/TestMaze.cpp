@@ -0,0 +1,49 @@
+#include "TestMaze.h"
+
+#include <QTest>
+
+#include "Maze.h"
+
+namespace mms {
+
+void TestMaze::roundTripsWalls() {
+  // Row-major from the bottom left: a wall between (0, 0) and (1, 0), one
+  // between (1, 0) and (1, 1), and one between (2, 1) and (3, 1)
+  const QVector<int> cells = {14, 13, 4, 6, 9, 5, 3, 11};
+  Maze *maze = Maze::fromWalls(4, 2, cells);
+  QVERIFY(maze != nullptr);
+  QCOMPARE(maze->getWidth(), 4);
+  QCOMPARE(maze->getHeight(), 2);
+  QCOMPARE(maze->toWalls(), cells);
+  delete maze;
+}
+
+void TestMaze::sharesWallsBetweenNeighbours() {
+  Maze *maze = Maze::fromWalls(4, 2, {14, 13, 4, 6, 9, 5, 3, 11});
+  QVERIFY(maze != nullptr);
+
+  // Vertical edges
+  QVERIFY(maze->isWall(0, 0, Direction::EAST));
+  QVERIFY(maze->isWall(1, 0, Direction::WEST));
+  QVERIFY(!maze->isWall(1, 0, Direction::EAST));
+  QVERIFY(!maze->isWall(2, 0, Direction::WEST));
+  QVERIFY(maze->isWall(2, 1, Direction::EAST));
+  QVERIFY(maze->isWall(3, 1, Direction::WEST));
+  QVERIFY(!maze->isWall(0, 1, Direction::EAST));
+  QVERIFY(!maze->isWall(1, 1, Direction::WEST));
+
+  // Horizontal edges
+  QVERIFY(maze->isWall(1, 0, Direction::NORTH));
+  QVERIFY(maze->isWall(1, 1, Direction::SOUTH));
+  QVERIFY(!maze->isWall(3, 0, Direction::NORTH));
+  QVERIFY(!maze->isWall(3, 1, Direction::SOUTH));
+
+  // The outside of the maze
+  QVERIFY(maze->isWall(3, 0, Direction::EAST));
+  QVERIFY(maze->isWall(3, 1, Direction::NORTH));
+  QVERIFY(maze->isWall(0, 1, Direction::WEST));
+  QVERIFY(maze->isWall(2, 0, Direction::SOUTH));
+  delete maze;
+}
+
+}  // namespace mms
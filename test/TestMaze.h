@@ -0,0 +1,19 @@
+#pragma once
+
+#include <QObject>
+
+namespace mms {
+
+class TestMaze : public QObject {
+  Q_OBJECT
+
+ private slots:
+  // Walls are stored once per edge, so every cell must come back as it went
+  // in, on a maze that's wider than it is tall
+  void roundTripsWalls();
+
+  // Both cells next to an edge see the same wall
+  void sharesWallsBetweenNeighbours();
+};
+
+}  // namespace mms
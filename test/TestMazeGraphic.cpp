@@ -0,0 +1,131 @@
+#include "TestMazeGraphic.h"
+
+#include <QTest>
+
+#include "Color.h"
+
+namespace mms {
+
+namespace {
+
+const int NORTH_BIT = 1 << static_cast<int>(Direction::NORTH);
+const int SOUTH_BIT = 1 << static_cast<int>(Direction::SOUTH);
+
+// The cells are stored column by column, so (x, 0) of a maze one cell tall
+// is at index x
+MazeGraphic::TileState stateOf(MazeGraphic *graphic, int x) {
+  return graphic->getTileStates().at(x);
+}
+
+}  // namespace
+
+TestMazeGraphic::TestMazeGraphic() : m_maze(nullptr), m_view(nullptr) {}
+
+void TestMazeGraphic::init() {
+  // Just the outer walls
+  m_maze = Maze::fromWalls(2, 1, {13, 7});
+  QVERIFY(m_maze != nullptr);
+  m_view = new MazeView(m_maze, false);
+}
+
+void TestMazeGraphic::cleanup() {
+  delete m_view;
+  delete m_maze;
+}
+
+void TestMazeGraphic::keepsLastWallChange() {
+  graphic()->setWall(0, 0, Direction::EAST);
+  graphic()->clearWall(0, 0, Direction::EAST);
+  graphic()->clearWall(0, 0, Direction::NORTH);
+  graphic()->setWall(0, 0, Direction::NORTH);
+  QCOMPARE(stateOf(graphic(), 0).walls, NORTH_BIT);
+  graphic()->applyPendingChanges();
+  QCOMPARE(stateOf(graphic(), 0).walls, NORTH_BIT);
+}
+
+void TestMazeGraphic::keepsLastColorChange() {
+  graphic()->setColor(0, 0, Color::RED);
+  graphic()->clearColor(0, 0);
+  graphic()->clearColor(1, 0);
+  graphic()->setColor(1, 0, Color::BLUE);
+  graphic()->applyPendingChanges();
+  QVERIFY(!stateOf(graphic(), 0).isColorSet);
+  QVERIFY(stateOf(graphic(), 1).isColorSet);
+  QVERIFY(stateOf(graphic(), 1).color == Color::BLUE);
+
+  // A color set in an earlier frame is still cleared by a later one
+  graphic()->setColor(1, 0, Color::GREEN);
+  graphic()->clearColor(1, 0);
+  graphic()->applyPendingChanges();
+  QVERIFY(!stateOf(graphic(), 1).isColorSet);
+}
+
+void TestMazeGraphic::keepsLastTextChange() {
+  graphic()->setText(0, 0, "abc");
+  graphic()->clearText(0, 0);
+  graphic()->clearText(1, 0);
+  graphic()->setText(1, 0, "xyz");
+  graphic()->applyPendingChanges();
+  QCOMPARE(stateOf(graphic(), 0).text, QString());
+  QCOMPARE(stateOf(graphic(), 1).text, QString("xyz"));
+}
+
+void TestMazeGraphic::tileStatesIncludePendingChanges() {
+  graphic()->setWall(0, 0, Direction::NORTH);
+  graphic()->setWall(0, 0, Direction::EAST);
+  graphic()->setColor(0, 0, Color::RED);
+  graphic()->setText(0, 0, "abc");
+  graphic()->applyPendingChanges();
+
+  // Pending changes win over the applied ones, and the rest shows through
+  graphic()->clearWall(0, 0, Direction::EAST);
+  graphic()->setWall(0, 0, Direction::SOUTH);
+  graphic()->setColor(0, 0, Color::BLUE);
+  MazeGraphic::TileState state = stateOf(graphic(), 0);
+  QCOMPARE(state.walls, NORTH_BIT | SOUTH_BIT);
+  QVERIFY(state.isColorSet);
+  QVERIFY(state.color == Color::BLUE);
+  QCOMPARE(state.text, QString("abc"));
+
+  // Cells without pending changes show their applied state
+  QCOMPARE(stateOf(graphic(), 1).walls, 0);
+  QVERIFY(!stateOf(graphic(), 1).isColorSet);
+}
+
+void TestMazeGraphic::setTileStatesRestoresSavedStates() {
+  graphic()->setWall(0, 0, Direction::NORTH);
+  graphic()->setColor(0, 0, Color::RED);
+  graphic()->setText(1, 0, "abc");
+  graphic()->applyPendingChanges();
+  QVector<MazeGraphic::TileState> saved = graphic()->getTileStates();
+  QCOMPARE(saved.at(0).walls, NORTH_BIT);
+  QCOMPARE(saved.at(1).text, QString("abc"));
+
+  // One frame of applied changes, then some still pending
+  graphic()->clearWall(0, 0, Direction::NORTH);
+  graphic()->setWall(1, 0, Direction::EAST);
+  graphic()->clearColor(0, 0);
+  graphic()->applyPendingChanges();
+  graphic()->setColor(1, 0, Color::GREEN);
+  graphic()->setText(1, 0, "xyz");
+
+  graphic()->setTileStates(saved);
+  for (int i = 0; i < 2; i += 1) {
+    QVector<MazeGraphic::TileState> states = graphic()->getTileStates();
+    QCOMPARE(states.size(), saved.size());
+    for (int x = 0; x < states.size(); x += 1) {
+      QCOMPARE(states.at(x).walls, saved.at(x).walls);
+      QCOMPARE(states.at(x).isColorSet, saved.at(x).isColorSet);
+      if (saved.at(x).isColorSet) {
+        QVERIFY(states.at(x).color == saved.at(x).color);
+      }
+      QCOMPARE(states.at(x).text, saved.at(x).text);
+    }
+    // Check again once the restored states have been applied
+    graphic()->applyPendingChanges();
+  }
+}
+
+MazeGraphic *TestMazeGraphic::graphic() { return m_view->getMazeGraphic(); }
+
+}  // namespace mms
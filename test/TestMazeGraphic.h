@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QObject>
+
+#include "Maze.h"
+#include "MazeView.h"
+
+namespace mms {
+
+class TestMazeGraphic : public QObject {
+  Q_OBJECT
+
+ public:
+  TestMazeGraphic();
+
+ private slots:
+  void init();
+  void cleanup();
+
+  // Only the last change to a cell within a frame is kept
+  void keepsLastWallChange();
+  void keepsLastColorChange();
+  void keepsLastTextChange();
+
+  // Tile states show pending changes on top of the applied ones, since
+  // replay keyframes are taken between frames
+  void tileStatesIncludePendingChanges();
+
+  // Restoring tile states undoes both applied and pending changes
+  void setTileStatesRestoresSavedStates();
+
+ private:
+  Maze *m_maze;
+  MazeView *m_view;
+
+  MazeGraphic *graphic();
+};
+
+}  // namespace mms
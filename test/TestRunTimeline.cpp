@@ -0,0 +1,42 @@
+#include "TestRunTimeline.h"
+
+#include <QTest>
+
+#include "RunTimeline.h"
+
+namespace mms {
+
+void TestRunTimeline::dropsClosedSpansFirst() {
+  RunTimeline timeline;
+  timeline.beginSpan("outer", 0);
+  for (int i = 0; i < RunTimeline::MAX_EVENTS; i += 1) {
+    timeline.beginSpan("inner", i);
+    timeline.endSpan("inner", i);
+  }
+  QVERIFY(timeline.getSpans().size() <= RunTimeline::MAX_EVENTS);
+  QCOMPARE(timeline.getSpans().first().label, QString("outer"));
+  QCOMPARE(timeline.getSpans().last().depth, 1);
+
+  timeline.endSpan("outer", RunTimeline::MAX_EVENTS);
+  QCOMPARE(timeline.getSpans().first().endMicros,
+           static_cast<qint64>(RunTimeline::MAX_EVENTS));
+}
+
+void TestRunTimeline::capsSpansThatNeverEnd() {
+  RunTimeline timeline;
+  for (int i = 0; i <= RunTimeline::MAX_EVENTS; i += 1) {
+    timeline.beginSpan(i % 2 == 0 ? "even" : "odd", i);
+  }
+  QVERIFY(timeline.getSpans().size() <= RunTimeline::MAX_EVENTS);
+  QCOMPARE(timeline.getSpans().last().beginMicros,
+           static_cast<qint64>(RunTimeline::MAX_EVENTS));
+
+  // The oldest ones were forgotten, and the newest can still be ended
+  QCOMPARE(timeline.getSpans().first().beginMicros,
+           static_cast<qint64>(RunTimeline::MAX_EVENTS / 10));
+  timeline.endSpan("even", RunTimeline::MAX_EVENTS + 1);
+  QCOMPARE(timeline.getSpans().last().endMicros,
+           static_cast<qint64>(RunTimeline::MAX_EVENTS + 1));
+}
+
+}  // namespace mms
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <QObject>
+
+namespace mms {
+
+class TestRunTimeline : public QObject {
+  Q_OBJECT
+
+ private slots:
+  // Closed spans are dropped before open ones, which can still be ended
+  void dropsClosedSpansFirst();
+
+  // Spans that are never ended don't grow the timeline without bound either
+  void capsSpansThatNeverEnd();
+};
+
+}  // namespace mms
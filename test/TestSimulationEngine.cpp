@@ -0,0 +1,275 @@
+#include "TestSimulationEngine.h"
+
+#include <QTest>
+#include <limits>
+
+#include "Color.h"
+
+namespace mms {
+
+const int TestSimulationEngine::WIDTH = 3;
+const int TestSimulationEngine::HEIGHT = 2;
+
+TestSimulationEngine::TestSimulationEngine()
+    : m_maze(nullptr),
+      m_view(nullptr),
+      m_engine(nullptr),
+      m_device(nullptr) {}
+
+void TestSimulationEngine::init() {
+  // Just the outer walls
+  m_maze = Maze::fromWalls(WIDTH, HEIGHT, {12, 4, 6, 9, 1, 3});
+  QVERIFY(m_maze != nullptr);
+  m_view = new MazeView(m_maze, false);
+  m_device = new QBuffer();
+  m_device->open(QIODevice::ReadWrite);
+  m_engine = new SimulationEngine();
+  m_engine->setMaze(m_maze);
+  m_engine->startRun(m_device, m_view);
+}
+
+void TestSimulationEngine::cleanup() {
+  m_engine->stopRun();
+  m_engine->removeMouse();
+  delete m_engine;
+  delete m_device;
+  delete m_view;
+  delete m_maze;
+}
+
+void TestSimulationEngine::setColorsExpandsRuns() {
+  // Row-major from (0, 0), and '.' clears
+  send("setColor 1 1 B");
+  send("setColors 0 0 3 2 2R.G2Y");
+  QVERIFY(tile(0, 0).isColorSet && tile(0, 0).color == Color::DARK_RED);
+  QVERIFY(tile(1, 0).isColorSet && tile(1, 0).color == Color::DARK_RED);
+  QVERIFY(!tile(2, 0).isColorSet);
+  QVERIFY(tile(0, 1).isColorSet && tile(0, 1).color == Color::DARK_GREEN);
+  QVERIFY(tile(1, 1).isColorSet && tile(1, 1).color == Color::DARK_YELLOW);
+  QVERIFY(tile(2, 1).isColorSet && tile(2, 1).color == Color::DARK_YELLOW);
+
+  // Fewer colors than cells leave the rest alone
+  send("setColors 0 0 3 2 .");
+  QVERIFY(!tile(0, 0).isColorSet);
+  QVERIFY(tile(1, 0).isColorSet && tile(1, 0).color == Color::DARK_RED);
+}
+
+void TestSimulationEngine::setColorsRejectsRunPastGrid() {
+  send("setColors 0 0 3 2 7R");
+  send("setColors 0 0 3 2 4R3G");
+  send("setColors 0 0 3 2 99999999999R");
+  for (int x = 0; x < WIDTH; x += 1) {
+    for (int y = 0; y < HEIGHT; y += 1) {
+      QVERIFY(!tile(x, y).isColorSet);
+    }
+  }
+}
+
+void TestSimulationEngine::setColorsRejectsTrailingCount() {
+  send("setColors 0 0 3 2 R2");
+  send("setColors 0 0 3 2 2R3");
+  send("setColors 0 0 3 2 2R?");
+  for (int x = 0; x < WIDTH; x += 1) {
+    for (int y = 0; y < HEIGHT; y += 1) {
+      QVERIFY(!tile(x, y).isColorSet);
+    }
+  }
+}
+
+void TestSimulationEngine::setTextsClearsEmptyFields() {
+  send("setTexts 0 0 3 2 a|b|c|d|e|f");
+  send("setTexts 0 0 3 2 x||y z");
+  QCOMPARE(tile(0, 0).text, QString("x"));
+  QCOMPARE(tile(1, 0).text, QString());
+  QCOMPARE(tile(2, 0).text, QString("y z"));
+  QCOMPARE(tile(0, 1).text, QString("d"));
+
+  // A trailing separator clears the cell after it
+  send("setTexts 1 1 2 1 |");
+  QCOMPARE(tile(1, 1).text, QString());
+  QCOMPARE(tile(2, 1).text, QString());
+}
+
+void TestSimulationEngine::setTextsRejectsTooManyFields() {
+  send("setTexts 0 0 3 2 a|b|c|d|e|f|g");
+  send("setTexts 0 0 1 1 a|b");
+  for (int x = 0; x < WIDTH; x += 1) {
+    for (int y = 0; y < HEIGHT; y += 1) {
+      QCOMPARE(tile(x, y).text, QString());
+    }
+  }
+}
+
+void TestSimulationEngine::setWallsRejectsWrongLengthAndConflicts() {
+  // Exactly one digit per cell
+  send("setWalls c6e93b0");
+  send("setWalls c6e93");
+  QCOMPARE(tile(0, 0).walls, 0);
+
+  // (0, 0) has an east wall that (1, 0) doesn't have on its west
+  send("setWalls e6e93b");
+  QCOMPARE(tile(0, 0).walls, 0);
+  QCOMPARE(tile(1, 0).walls, 0);
+
+  // Both sides of every wall are set, in upper or lower case
+  send("setWalls c6E93B");
+  QCOMPARE(tile(0, 0).walls, 12);
+  QCOMPARE(tile(1, 0).walls, 6);
+  QCOMPARE(tile(2, 0).walls, 14);
+  QCOMPARE(tile(0, 1).walls, 9);
+  QCOMPARE(tile(1, 1).walls, 3);
+  QCOMPARE(tile(2, 1).walls, 11);
+
+  // And cleared, on both sides
+  send("setWalls c4693b");
+  QCOMPARE(tile(1, 0).walls, 4);
+  QCOMPARE(tile(2, 0).walls, 6);
+}
+
+void TestSimulationEngine::subscribePushesResetInText() {
+  send("subscribe reset");
+  QCOMPARE(m_device->data(), QByteArray("ack\n"));
+  m_engine->requestReset();
+  QCOMPARE(m_device->data(), QByteArray("ack\nevent reset\n"));
+  send("wasReset");
+  QCOMPARE(m_device->data(), QByteArray("ack\nevent reset\ntrue\n"));
+}
+
+void TestSimulationEngine::subscribeIsRefusedInBinary() {
+  // The handshake is answered in text, subscribe with false
+  send("useBinaryProtocol");
+  m_engine->receiveCommands(QByteArray(1, 0x42));
+  QCOMPARE(m_device->data(), QByteArray("ack\n\x00", 5));
+
+  // Nothing is pushed, but the reset can still be polled
+  m_engine->requestReset();
+  QCOMPARE(m_device->data(), QByteArray("ack\n\x00", 5));
+  m_engine->receiveCommands(QByteArray(1, 0x40));
+  QCOMPARE(m_device->data(), QByteArray("ack\n\x00\x01", 6));
+}
+
+void TestSimulationEngine::moveUntilStopsAtOpeningOrWall() {
+  // A corridor up the west column, with an opening to the east at (0, 2)
+  Maze *maze = Maze::fromWalls(2, 4, {14, 14, 10, 10, 8, 2, 11, 11});
+  QVERIFY(maze != nullptr);
+
+  // Openings are only found at the center of a cell, four half steps up
+  QCOMPARE(runHeadless(maze, "moveUntilOpening R\n"), QByteArray("4\n"));
+  QCOMPARE(runHeadless(maze, "moveUntilOpening\n"), QByteArray("4\n"));
+  QCOMPARE(runHeadless(maze, "moveUntilOpening any\n"), QByteArray("4\n"));
+
+  // There's no opening to the west, so that's the same as moveUntilWall
+  QCOMPARE(runHeadless(maze, "moveUntilOpening L\n"), QByteArray("6\n"));
+  QCOMPARE(runHeadless(maze, "moveUntilWall\n"), QByteArray("6\n"));
+
+  // And from the opening, on to the end of the corridor
+  QCOMPARE(runHeadless(maze, "moveUntilOpening R\nmoveUntilOpening L\n"),
+           QByteArray("4\n2\n"));
+  delete maze;
+}
+
+void TestSimulationEngine::moveUntilAnswersZeroWhenFacingWall() {
+  Maze *maze = Maze::fromWalls(2, 4, {14, 14, 10, 10, 8, 2, 11, 11});
+  QVERIFY(maze != nullptr);
+  QCOMPARE(runHeadless(maze, "moveUntilWall\nmoveUntilWall\n"),
+           QByteArray("6\n0\n"));
+  QCOMPARE(runHeadless(maze, "turnLeft\nmoveUntilWall\n"),
+           QByteArray("ack\n0\n"));
+  QCOMPARE(runHeadless(maze, "turnRight\nmoveUntilOpening\n"),
+           QByteArray("ack\n0\n"));
+
+  // Facing a wall isn't a crash, and the mouse didn't move
+  QCOMPARE(runHeadless(maze, "turnLeft\nmoveUntilWall\nturnRight\n"
+                             "moveUntilWall\n"),
+           QByteArray("ack\n0\nack\n6\n"));
+  delete maze;
+}
+
+void TestSimulationEngine::moveUntilOpeningIgnoresSidesOnDiagonal() {
+  // Outer walls, plus walls north of (0, 0) and east of (1, 0)
+  Maze *maze = Maze::fromWalls(3, 3, {13, 6, 14, 12, 0, 2, 9, 1, 3});
+  QVERIFY(maze != nullptr);
+
+  // Half a step east, then northeast through (1, 1) until the wall east of
+  // (2, 2); with the sides checked, the first half step would already have
+  // an opening to the northwest
+  QByteArray start = "turnRight\nmoveForwardHalf\nturnLeft45\n";
+  QCOMPARE(runHeadless(maze, start + "moveUntilOpening\n"),
+           QByteArray("ack\nack\nack\n3\n"));
+  QCOMPARE(runHeadless(maze, start + "moveUntilOpening L\nmoveUntilWall\n"),
+           QByteArray("ack\nack\nack\n3\n0\n"));
+  delete maze;
+}
+
+void TestSimulationEngine::wallsKeepsBitOrder() {
+  // Outer walls, plus walls north of (0, 0) and east of (1, 0)
+  Maze *maze = Maze::fromWalls(3, 3, {13, 6, 14, 12, 0, 2, 9, 1, 3});
+  QVERIFY(maze != nullptr);
+
+  // Front 1, right 2, back 4, left 8, front right 16, front left 32, back
+  // right 64, and back left 128. Half a step east of the start, facing east,
+  // everything but front, back, and front left is a wall (218), then facing
+  // north, everything but right, left, and front right (229). At the center
+  // of (1, 0), facing east, it's front, right, and the corners (243).
+  QCOMPARE(runHeadless(maze, "turnRight\nmoveForwardHalf\nwalls\n"
+                             "turnLeft\nwalls\n"
+                             "turnRight\nmoveForwardHalf\nwalls\n"),
+           QByteArray("ack\nack\n218\nack\n229\nack\nack\n243\n"));
+
+  // The same bits, as a single byte
+  const char binary[] = {0x22, 0x21, 0x01, 0x00, 0x18, 0x01, 0x00,
+                         0x23, 0x18, 0x01, 0x00,
+                         0x22, 0x21, 0x01, 0x00, 0x18, 0x01, 0x00};
+  const char expected[] = {0x02, 0x02, '\xDA', 0x02, '\xE5', 0x02, 0x02,
+                           '\xF3'};
+  QCOMPARE(runHeadless(maze, QByteArray("useBinaryProtocol\n") +
+                                 QByteArray(binary, sizeof(binary))),
+           QByteArray("ack\n") + QByteArray(expected, sizeof(expected)));
+  delete maze;
+}
+
+void TestSimulationEngine::sensingAckKeepsBitOrder() {
+  // The maze and positions of wallsKeepsBitOrder, starting at the center of
+  // (0, 0) facing east, where everything but the front is a wall (254)
+  Maze *maze = Maze::fromWalls(3, 3, {13, 6, 14, 12, 0, 2, 9, 1, 3});
+  QVERIFY(maze != nullptr);
+  QCOMPARE(runHeadless(maze, "useSensing\nturnRight\nmoveForwardHalf\n"
+                             "turnLeft\nturnRight\nmoveForwardHalf\n"),
+           QByteArray("ack\nack 254\nack 218\nack 229\nack 218\n"
+                      "ack 243\n"));
+
+  // An ack byte followed by the walls byte
+  const char binary[] = {0x70, 0x22, 0x21, 0x01, 0x00,
+                         0x23, 0x22, 0x21, 0x01, 0x00};
+  const char expected[] = {0x02, 0x02, '\xFE', 0x02, '\xDA', 0x02,
+                           '\xE5', 0x02, '\xDA', 0x02, '\xF3'};
+  QCOMPARE(runHeadless(maze, QByteArray("useBinaryProtocol\n") +
+                                 QByteArray(binary, sizeof(binary))),
+           QByteArray("ack\n") + QByteArray(expected, sizeof(expected)));
+  delete maze;
+}
+
+void TestSimulationEngine::send(const QByteArray &line) {
+  m_engine->receiveCommands(line + "\n");
+}
+
+MazeGraphic::TileState TestSimulationEngine::tile(int x, int y) const {
+  // Column by column
+  return m_view->getMazeGraphic()->getTileStates().at(x * HEIGHT + y);
+}
+
+QByteArray TestSimulationEngine::runHeadless(const Maze *maze,
+                                             const QByteArray &input) {
+  QBuffer device;
+  device.open(QIODevice::ReadWrite);
+  SimulationEngine engine;
+  engine.setMaze(maze);
+  engine.setRealTimeFactor(std::numeric_limits<double>::infinity());
+  engine.startRun(&device, nullptr);
+  engine.receiveCommands(input);
+  engine.stopRun();
+  engine.removeMouse();
+  return device.data();
+}
+
+}  // namespace mms
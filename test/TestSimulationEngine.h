@@ -0,0 +1,65 @@
+#pragma once
+
+#include <QBuffer>
+#include <QObject>
+
+#include "Maze.h"
+#include "MazeGraphic.h"
+#include "MazeView.h"
+#include "SimulationEngine.h"
+
+namespace mms {
+
+// Runs the bulk visualization commands against a maze view, without a window
+class TestSimulationEngine : public QObject {
+  Q_OBJECT
+
+ public:
+  TestSimulationEngine();
+
+ private slots:
+  void init();
+  void cleanup();
+
+  void setColorsExpandsRuns();
+  void setColorsRejectsRunPastGrid();
+  void setColorsRejectsTrailingCount();
+  void setTextsClearsEmptyFields();
+  void setTextsRejectsTooManyFields();
+  void setWallsRejectsWrongLengthAndConflicts();
+
+  // Events are pushed in text, and the binary protocol refuses to subscribe
+  // rather than leaving the algorithm waiting for an answer
+  void subscribePushesResetInText();
+  void subscribeIsRefusedInBinary();
+
+  // Corridors are followed to the center of the first cell with an opening
+  // on the given side, or to the wall at their end
+  void moveUntilStopsAtOpeningOrWall();
+  void moveUntilAnswersZeroWhenFacingWall();
+
+  // Sides aren't checked on a diagonal, which only stops at a wall
+  void moveUntilOpeningIgnoresSidesOnDiagonal();
+
+  // Algorithms hard-code the order of the wall bits, in both protocols
+  void wallsKeepsBitOrder();
+  void sensingAckKeepsBitOrder();
+
+ private:
+  static const int WIDTH;
+  static const int HEIGHT;
+
+  Maze *m_maze;
+  MazeView *m_view;
+  SimulationEngine *m_engine;
+  QBuffer *m_device;
+
+  void send(const QByteArray &line);
+
+  // Runs the input on a headless engine at unbounded speed, so that every
+  // movement completes right away, and returns everything it wrote back
+  static QByteArray runHeadless(const Maze *maze, const QByteArray &input);
+  MazeGraphic::TileState tile(int x, int y) const;
+};
+
+}  // namespace mms
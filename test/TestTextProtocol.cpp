@@ -0,0 +1,97 @@
+#include "TestTextProtocol.h"
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QSet>
+#include <QTest>
+#include <iterator>
+
+#include "Command.h"
+#include "NameTable.h"
+#include "TextProtocol.h"
+
+namespace mms {
+
+void TestTextProtocol::roundTripsCommandNames() {
+  static constexpr NameTable<CommandType,
+                             std::size(TextProtocol::COMMAND_NAMES)>
+      table(TextProtocol::COMMAND_NAMES);
+  QVERIFY(table.isPerfect());
+  QSet<int> seen;
+  for (const NameEntry<CommandType> &entry : TextProtocol::COMMAND_NAMES) {
+    CommandType type = CommandType::INVALID;
+    QVERIFY2(table.lookup(QByteArrayView(entry.name), &type), entry.name);
+    QVERIFY2(type == entry.value, entry.name);
+    if (!seen.contains(static_cast<int>(type))) {
+      QCOMPARE(TextProtocol::commandName(type).toByteArray(),
+               QByteArray(entry.name));
+      seen.insert(static_cast<int>(type));
+    }
+  }
+
+  // Commands without arguments parse from their names alone
+  QVERIFY(TextProtocol::parse("mazeWidth").type == CommandType::MAZE_WIDTH);
+  QVERIFY(TextProtocol::parse("turnRight90").type ==
+          CommandType::TURN_RIGHT_90);
+  QVERIFY(TextProtocol::parse("wasReset\r").type == CommandType::WAS_RESET);
+}
+
+void TestTextProtocol::rejectsNearMissNames() {
+  static constexpr NameTable<CommandType,
+                             std::size(TextProtocol::COMMAND_NAMES)>
+      table(TextProtocol::COMMAND_NAMES);
+  const char *names[] = {
+      "",           "m",         "mazeWidt",   "mazeWidthh", "xmazeWidth",
+      "MazeWidth",  "mazewidth", "turnRight9", "wall",       "wallsx",
+      "spanbegin",  "setColor ", "unknown",
+  };
+  for (const char *name : names) {
+    CommandType type = CommandType::INVALID;
+    QVERIFY2(!table.lookup(QByteArrayView(name), &type), name);
+    QVERIFY2(type == CommandType::INVALID, name);
+  }
+  QVERIFY(TextProtocol::parse("mazeWidthh").type == CommandType::INVALID);
+  QVERIFY(TextProtocol::parse("turnRight9").type == CommandType::INVALID);
+  QVERIFY(TextProtocol::parse("").type == CommandType::INVALID);
+}
+
+void TestTextProtocol::capsIntegerDigits() {
+  Command command = TextProtocol::parse("setColor 123456789 -123456789 R");
+  QVERIFY(command.type == CommandType::SET_COLOR);
+  QCOMPARE(command.x, 123456789);
+  QCOMPARE(command.y, -123456789);
+  QVERIFY(TextProtocol::parse("setColor 1234567890 0 R").type ==
+          CommandType::INVALID);
+  QVERIFY(TextProtocol::parse("setColor 0 -1234567890 R").type ==
+          CommandType::INVALID);
+  QVERIFY(TextProtocol::parse("setColor - 0 R").type == CommandType::INVALID);
+  QVERIFY(TextProtocol::parse("setColor 1x 0 R").type ==
+          CommandType::INVALID);
+
+  // A malformed distance reads as zero, rather than making the move invalid
+  command = TextProtocol::parse("moveForward 999999999");
+  QVERIFY(command.type == CommandType::MOVE_FORWARD);
+  QCOMPARE(command.n, 999999999);
+  command = TextProtocol::parse("moveForward 1000000000");
+  QVERIFY(command.type == CommandType::MOVE_FORWARD);
+  QCOMPARE(command.n, 0);
+}
+
+void TestTextProtocol::refinesSpanBeginAndEnd() {
+  Command command = TextProtocol::parse("span begin flood fill");
+  QVERIFY(command.type == CommandType::SPAN_BEGIN);
+  QCOMPARE(command.text, QString("flood fill"));
+  command = TextProtocol::parse("span end  flood fill\r");
+  QVERIFY(command.type == CommandType::SPAN_END);
+  QCOMPARE(command.text, QString("flood fill"));
+
+  // Either edge needs a label, and nothing else is an edge
+  QVERIFY(TextProtocol::parse("span begin").type == CommandType::INVALID);
+  QVERIFY(TextProtocol::parse("span end   ").type == CommandType::INVALID);
+  QVERIFY(TextProtocol::parse("span flood").type == CommandType::INVALID);
+  QVERIFY(TextProtocol::parse("span").type == CommandType::INVALID);
+  QVERIFY(TextProtocol::parse("span beginning x").type ==
+          CommandType::INVALID);
+}
+
+}  // namespace mms
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <QObject>
+
+namespace mms {
+
+class TestTextProtocol : public QObject {
+  Q_OBJECT
+
+ private slots:
+  // Every name, aliases included, is found in the perfect hash table, and
+  // the first name of each command type is its canonical one
+  void roundTripsCommandNames();
+
+  // Lookups compare the whole name, not just its hash slot
+  void rejectsNearMissNames();
+
+  // At most nine digits, so a value can't overflow
+  void capsIntegerDigits();
+
+  void refinesSpanBeginAndEnd();
+};
+
+}  // namespace mms
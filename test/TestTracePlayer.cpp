@@ -0,0 +1,61 @@
+#include "TestTracePlayer.h"
+
+#include <QTest>
+#include <limits>
+
+#include "Maze.h"
+#include "RunTrace.h"
+#include "SimulationEngine.h"
+#include "TracePlayer.h"
+
+namespace mms {
+
+void TestTracePlayer::seekKeepsTimelineAndLatency() {
+  // Enough turns for a few keyframes, each after a marker
+  const qint64 numTurns = 1500;
+  QVector<TraceRecord> records;
+  for (qint64 i = 0; i < numTurns; i += 1) {
+    records.append({TraceKind::COMMANDS, 100 * i, "mark turn\nturnRight\n"});
+    records.append({TraceKind::RESPONSES, 100 * i + 40, "ack\n"});
+  }
+
+  Maze *maze = Maze::fromWalls(1, 1, {15});
+  QVERIFY(maze != nullptr);
+  SimulationEngine engine;
+  engine.setMaze(maze);
+  engine.setRealTimeFactor(std::numeric_limits<double>::infinity());
+  TracePlayer player(&engine, records);
+  player.start(nullptr, true);
+
+  // A movement and a mark per turn, and think time between turns
+  auto verifyCounts = [&]() {
+    QCOMPARE(player.getPositionMicros(), player.getDurationMicros());
+    QCOMPARE(static_cast<qint64>(engine.getTimeline()->getEvents().size()),
+             2 * numTurns);
+    const CommandLatency *latency = engine.getLatency();
+    QCOMPARE(latency->getServiceTimes(CommandType::TURN_RIGHT_90).getCount(),
+             numTurns);
+    QCOMPARE(latency->getThinkTimes(CommandType::TURN_RIGHT_90).getCount(),
+             numTurns - 1);
+    QCOMPARE(latency->getTotalServiceMicros(), 40 * numTurns);
+    QCOMPARE(latency->getTotalThinkMicros(), 60 * (numTurns - 1));
+
+    // Timed by the recording, not by how fast the replay went
+    const TimelineEvent &turn = engine.getTimeline()->getEvents().last();
+    QVERIFY(turn.kind == TimelineKind::MOVEMENT);
+    QCOMPARE(turn.beginMicros, 100 * (numTurns - 1));
+    QCOMPARE(turn.endMicros, 100 * (numTurns - 1) + 40);
+  };
+  verifyCounts();
+  player.seek(records.at(2 * records.size() / 3).micros);
+  verifyCounts();
+  player.seek(records.at(records.size() / 4).micros);
+  verifyCounts();
+  QCOMPARE(player.getNumDivergences(), 0);
+
+  engine.stopRun();
+  engine.removeMouse();
+  delete maze;
+}
+
+}  // namespace mms
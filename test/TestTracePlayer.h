@@ -0,0 +1,17 @@
+#pragma once
+
+#include <QObject>
+
+namespace mms {
+
+class TestTracePlayer : public QObject {
+  Q_OBJECT
+
+ private slots:
+  // Seeking replays the records after a keyframe again, which must not add
+  // to the timeline or the latency histograms a second time, and the times
+  // in both are the recorded ones
+  void seekKeepsTimelineAndLatency();
+};
+
+}  // namespace mms
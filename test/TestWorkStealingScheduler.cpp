@@ -0,0 +1,35 @@
+#include "TestWorkStealingScheduler.h"
+
+#include <QTest>
+
+#include "WorkStealingScheduler.h"
+
+namespace mms {
+
+void TestWorkStealingScheduler::dealsMostExpensiveFirst() {
+  WorkStealingScheduler scheduler(2);
+  scheduler.addJobs({1, 5, 3, 4});
+  QCOMPARE(scheduler.next(0), 1);
+  QCOMPARE(scheduler.next(1), 3);
+  QCOMPARE(scheduler.next(1), 2);
+  QCOMPARE(scheduler.next(0), 0);
+  QCOMPARE(scheduler.next(0), -1);
+  QCOMPARE(scheduler.numStolen(), 0);
+}
+
+void TestWorkStealingScheduler::stealsFromMostCostLeft() {
+  // Dealt as {0}, {1, 3, 5}, and {2, 4, 6, 7, 8, 9}
+  WorkStealingScheduler scheduler(3);
+  scheduler.addJobs({40, 8, 8, 8, 8, 8, 1, 1, 1, 1});
+  QCOMPARE(scheduler.next(1), 1);
+  QCOMPARE(scheduler.next(1), 3);
+  QCOMPARE(scheduler.next(1), 5);
+
+  // The single job of worker 0 outweighs the six of worker 2
+  QCOMPARE(scheduler.next(1), 0);
+  QCOMPARE(scheduler.next(1), 9);
+  QCOMPARE(scheduler.numStolen(), 2);
+  QCOMPARE(scheduler.numRemaining(), 5);
+}
+
+}  // namespace mms
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <QObject>
+
+namespace mms {
+
+class TestWorkStealingScheduler : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void dealsMostExpensiveFirst();
+
+  // The victim is the deque with the most cost left, not the most jobs
+  void stealsFromMostCostLeft();
+};
+
+}  // namespace mms
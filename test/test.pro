@@ -0,0 +1,52 @@
+QT += core
+QT += gui
+QT += opengl
+QT += openglwidgets
+QT += testlib
+QT += widgets
+QT += xml
+
+TEMPLATE = app
+
+CONFIG += c++11
+CONFIG += console
+CONFIG += debug
+CONFIG += object_parallel_to_source
+CONFIG += qt
+CONFIG -= app_bundle
+
+# Every test class is also run from Main.cpp
+SOURCES += Main.cpp
+SOURCES += TestBinaryProtocol.cpp
+SOURCES += TestLineSplitter.cpp
+SOURCES += TestMaze.cpp
+SOURCES += TestMazeGraphic.cpp
+SOURCES += TestRunTimeline.cpp
+SOURCES += TestSimulationEngine.cpp
+SOURCES += TestTextProtocol.cpp
+SOURCES += TestTracePlayer.cpp
+SOURCES += TestWorkStealingScheduler.cpp
+HEADERS += TestBinaryProtocol.h
+HEADERS += TestLineSplitter.h
+HEADERS += TestMaze.h
+HEADERS += TestMazeGraphic.h
+HEADERS += TestRunTimeline.h
+HEADERS += TestSimulationEngine.h
+HEADERS += TestTextProtocol.h
+HEADERS += TestTracePlayer.h
+HEADERS += TestWorkStealingScheduler.h
+
+# Everything but the simulator's own main
+SOURCES += $$files(../src/*.cpp, true)
+SOURCES -= ../src/Main.cpp
+HEADERS += $$files(../src/*.h, true)
+INCLUDEPATH += ../src
+RESOURCES = ../src/resources.qrc
+
+linux: LIBS += -lrt
+
+TARGET      = mms-test
+DESTDIR     = ../bin
+MOC_DIR     = ../build/test/moc
+OBJECTS_DIR = ../build/test/obj
+RCC_DIR     = ../build/test/rcc